@@ -8,7 +8,7 @@ namespace Simple2D
 	class Image;
 	class Font;
 
-	enum KeyCode;
+	enum KeyCode : int;
 
 	// - Creates a window object and its associated context.
 	Window*	CreateWindow(const std::string& sWindowName, int iWidth, int iHeight);
@@ -43,7 +43,7 @@ namespace Simple2D
 	// - Get elapsed time since game started
 	float GetGameTime();
 
-	enum KeyCode
+	enum KeyCode : int
 	{
 		KEY_NONE,
 		KEY_PAUSE,
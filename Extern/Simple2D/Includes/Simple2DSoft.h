@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Simple2D.h"
+
+// Extensions of the CPU (software) implementation of Simple2D.
+//
+// Environment variables read by CreateWindow:
+//	SIMPLE2D_DUMP=<dir>		write every refreshed frame to <dir>/frame_NNNNNN.png
+//	SIMPLE2D_FRAMES=<n>		ShouldWindowClose returns true after n refreshed frames
+//	SIMPLE2D_NOVSYNC=1		RefreshWindowBuffer does not wait for the 60 fps interval
+//	SIMPLE2D_THREADS=<n>	number of threads rasterizing tiles (default: hardware threads)
+//	SIMPLE2D_SIMD=<name>	force the blit kernel: scalar, sse2 or avx2 (default: best available)
+//	SIMPLE2D_KEYS=<list>	scripted keyboard, e.g. SPACE:1.0:2.5,D:1.2:1.4 holds a key (A-Z or SPACE)
+//							from the first to the second game time in seconds
+//
+// Every kernel produces bit-identical frames, so dumps can be compared pixel by pixel.
+namespace Simple2D
+{
+	// - Returns the RGBA8 pixels (R in the lowest byte, rows top-down) of the last refreshed frame.
+	const unsigned int* GetWindowBuffer(Window* pWindow, int* iWidth, int* iHeight);
+	// - Writes the last refreshed frame to a PNG file.
+	bool DumpWindowBuffer(Window* pWindow, const std::string& sFileName);
+	// - Returns the name of the blit kernel in use.
+	const char* GetBlitKernel();
+	// - Creates an image from RGBA8 pixels (rows top-down). Safe to call from any thread.
+	Image* CreateImageFromMemory(const void* pPixels, int iWidth, int iHeight);
+	// - Creates a font from a font file in memory; the memory must outlive the font.
+	Font* CreateFontFromMemory(const void* pData, size_t iSize, unsigned int iFontSize);
+}
@@ -0,0 +1,758 @@
+#include "Simple2DSoft.h"
+
+#include <cmath>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+
+#include <png.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMPLE2D_X86 1
+#endif
+
+// CPU implementation of Simple2D.
+// Coordinates follow the original library: origin at the bottom-left corner, y up,
+// images and strings are positioned by their center and rotated counter-clockwise.
+// Draw calls are recorded and rasterized by RefreshWindowBuffer, tile by tile on a
+// thread pool; every tile replays the commands in submission order.
+namespace Simple2D
+{
+	class Image
+	{
+	public:
+		int mW;
+		int mH;
+		std::vector<uint32_t> mPixels;	// RGBA8, rows top-down
+	};
+
+	class Font
+	{
+	public:
+		FT_Face mFace;
+		unsigned int mSize;
+		std::unordered_map<std::string, Image*> mCache;	// rendered strings
+	};
+
+	struct Command
+	{
+		const Image* mImage;
+		int mX0, mY0, mX1, mY1;	// covered pixels [x0, x1) x [y0, y1)
+		bool mIsAxis;			// no rotation and no scale: straight copy
+		int mLeft, mTop;		// axis aligned: top-left pixel of the image
+		float mUA, mUB, mUC;	// rotated: texel u = ua * x + (ub * y + uc)
+		float mVA, mVB, mVC;	// rotated: texel v = va * x + (vb * y + vc)
+	};
+
+	class Window
+	{
+	public:
+		int mW;
+		int mH;
+		bool mIsVsync;
+		int mMaxFrames;
+		uint64_t mFrames;
+		std::string mDump;
+		std::vector<uint32_t> mPixels;
+		std::vector<Command> mCommands;
+		std::vector<Image*> mRetired;	//	evicted string images, still referenced by mCommands until the frame is drawn
+		std::chrono::steady_clock::time_point mLast;
+	};
+
+	static const int kTile = 64;
+	static const uint32_t kClear = 0xFF000000;
+
+	struct KeyScript
+	{
+		KeyCode mCode;
+		float mDown, mUp;		// held during [down, up) seconds of game time
+	};
+
+	static FT_Library sFreeType = nullptr;
+	static Window* sWindow = nullptr;
+	static auto sStart = std::chrono::steady_clock::now();
+	static std::vector<KeyScript> sKeys;
+
+	//	Pool
+
+	class TilePool
+	{
+	public:
+		void Start(unsigned int count)
+		{
+			for (unsigned int i = 1; i < count; ++i)
+			{
+				mThreads.emplace_back([this] { Work(); });
+			}
+		}
+
+		void Stop()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mIsStop = true;
+			}
+			mWake.notify_all();
+			for (auto& thread : mThreads) { thread.join(); }
+			mThreads.clear();
+			mIsStop = false;
+		}
+
+		// - Runs fn(0..count-1) on all threads, the caller included.
+		void Run(int count, const std::function<void(int)>& fn)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				// a worker still draining the previous run may pick up the new indices,
+				// so publish the job before the first index becomes available
+				mFn = &fn;
+				mCount = count;
+				mDone = 0;
+				mNext = 0;
+				++mEpoch;
+			}
+			mWake.notify_all();
+			Drain();
+
+			std::unique_lock<std::mutex> lock(mMutex);
+			mIdle.wait(lock, [this] { return mDone == mCount; });
+			mFn = nullptr;
+		}
+
+	private:
+		void Drain()
+		{
+			for (int i = mNext++; i < mCount; i = mNext++)
+			{
+				(*mFn)(i);
+				if (++mDone == mCount)
+				{
+					std::lock_guard<std::mutex> lock(mMutex);
+					mIdle.notify_all();
+				}
+			}
+		}
+
+		void Work()
+		{
+			uint64_t epoch = 0;
+			for (;;)
+			{
+				{
+					std::unique_lock<std::mutex> lock(mMutex);
+					mWake.wait(lock, [&] { return mIsStop || (mEpoch != epoch && mFn != nullptr); });
+					if (mIsStop) { return; }
+					epoch = mEpoch;
+				}
+				Drain();
+			}
+		}
+
+		std::vector<std::thread> mThreads;
+		std::mutex mMutex;
+		std::condition_variable mWake;
+		std::condition_variable mIdle;
+		std::atomic<const std::function<void(int)>*> mFn{ nullptr };
+		std::atomic<int> mNext{ 0 };
+		std::atomic<int> mDone{ 0 };
+		std::atomic<int> mCount{ 0 };
+		uint64_t mEpoch = 0;
+		bool mIsStop = false;
+	};
+
+	static TilePool sPool;
+
+	//	Kernels
+	//	dst = (src * a + dst * (255 - a)) / 255, rounded; every kernel uses the same integer math
+
+	static inline uint32_t Blend(uint32_t s, uint32_t d)
+	{
+		uint32_t a = s >> 24;
+		uint32_t r = 0;
+		for (int c = 0; c != 24; c += 8)
+		{
+			uint32_t t = ((s >> c) & 0xFF) * a + ((d >> c) & 0xFF) * (255 - a) + 128;
+			r |= (((t + (t >> 8)) >> 8) & 0xFF) << c;
+		}
+		return r | kClear;
+	}
+
+	static inline bool Sample(const Command& cmd, float u, float v, uint32_t& texel)
+	{
+		auto image = cmd.mImage;
+		if (u >= 0.0f && u < (float)image->mW && v >= 0.0f && v < (float)image->mH)
+		{
+			texel = image->mPixels[(size_t)((int)v * image->mW + (int)u)];
+			return true;
+		}
+		return false;
+	}
+
+	static void AxisScalar(uint32_t* dst, const uint32_t* src, int count)
+	{
+		for (int i = 0; i != count; ++i) { dst[i] = Blend(src[i], dst[i]); }
+	}
+
+	static void RotateScalar(const Command& cmd, uint32_t* dst, int x0, int x1, float ub, float vb)
+	{
+		for (int x = x0; x != x1; ++x)
+		{
+			uint32_t texel;
+			auto u = cmd.mUA * (float)x + ub;
+			auto v = cmd.mVA * (float)x + vb;
+			if (Sample(cmd, u, v, texel)) { dst[x] = Blend(texel, dst[x]); }
+		}
+	}
+
+#ifdef SIMPLE2D_X86
+	static inline __m128i Blend4(__m128i s, __m128i d)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i full = _mm_set1_epi16(255);
+		const __m128i half = _mm_set1_epi16(128);
+
+		auto lerp = [&](__m128i s16, __m128i d16)
+		{
+			auto a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s16, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			auto t = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s16, a),
+												 _mm_mullo_epi16(d16, _mm_sub_epi16(full, a))), half);
+			return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+		};
+		auto lo = lerp(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+		auto hi = lerp(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+		return _mm_or_si128(_mm_packus_epi16(lo, hi), _mm_set1_epi32((int)kClear));
+	}
+
+	static void AxisSSE2(uint32_t* dst, const uint32_t* src, int count)
+	{
+		int i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			auto s = _mm_loadu_si128((const __m128i*)(src + i));
+			auto d = _mm_loadu_si128((const __m128i*)(dst + i));
+			_mm_storeu_si128((__m128i*)(dst + i), Blend4(s, d));
+		}
+		AxisScalar(dst + i, src + i, count - i);
+	}
+
+	static void RotateSSE2(const Command& cmd, uint32_t* dst, int x0, int x1, float ub, float vb)
+	{
+		int x = x0;
+		for (; x + 4 <= x1; x += 4)
+		{
+			alignas(16) uint32_t texels[4];
+			for (int k = 0; k != 4; ++k)
+			{
+				auto u = cmd.mUA * (float)(x + k) + ub;
+				auto v = cmd.mVA * (float)(x + k) + vb;
+				if (!Sample(cmd, u, v, texels[k])) { texels[k] = 0; }
+			}
+			auto d = _mm_loadu_si128((const __m128i*)(dst + x));
+			_mm_storeu_si128((__m128i*)(dst + x), Blend4(_mm_load_si128((const __m128i*)texels), d));
+		}
+		RotateScalar(cmd, dst, x, x1, ub, vb);
+	}
+
+	__attribute__((target("avx2")))
+	static inline __m256i Blend8(__m256i s, __m256i d)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i full = _mm256_set1_epi16(255);
+		const __m256i half = _mm256_set1_epi16(128);
+
+		auto lerp = [&](__m256i s16, __m256i d16) __attribute__((target("avx2")))
+		{
+			auto a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s16, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			auto t = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(s16, a),
+													   _mm256_mullo_epi16(d16, _mm256_sub_epi16(full, a))), half);
+			return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+		};
+		auto lo = lerp(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero));
+		auto hi = lerp(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero));
+		return _mm256_or_si256(_mm256_packus_epi16(lo, hi), _mm256_set1_epi32((int)kClear));
+	}
+
+	__attribute__((target("avx2")))
+	static void AxisAVX2(uint32_t* dst, const uint32_t* src, int count)
+	{
+		int i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			auto s = _mm256_loadu_si256((const __m256i*)(src + i));
+			auto d = _mm256_loadu_si256((const __m256i*)(dst + i));
+			_mm256_storeu_si256((__m256i*)(dst + i), Blend8(s, d));
+		}
+		AxisScalar(dst + i, src + i, count - i);
+	}
+
+	__attribute__((target("avx2")))
+	static void RotateAVX2(const Command& cmd, uint32_t* dst, int x0, int x1, float ub, float vb)
+	{
+		auto image = cmd.mImage;
+		const __m256 ua = _mm256_set1_ps(cmd.mUA), ubv = _mm256_set1_ps(ub);
+		const __m256 va = _mm256_set1_ps(cmd.mVA), vbv = _mm256_set1_ps(vb);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 w = _mm256_set1_ps((float)image->mW);
+		const __m256 h = _mm256_set1_ps((float)image->mH);
+		const __m256i stride = _mm256_set1_epi32(image->mW);
+		const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+		int x = x0;
+		for (; x + 8 <= x1; x += 8)
+		{
+			auto fx = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32(x), lane));
+			auto u = _mm256_add_ps(_mm256_mul_ps(ua, fx), ubv);
+			auto v = _mm256_add_ps(_mm256_mul_ps(va, fx), vbv);
+			auto in = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(u, w, _CMP_LT_OQ)),
+									_mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GE_OQ), _mm256_cmp_ps(v, h, _CMP_LT_OQ)));
+			auto mask = _mm256_castps_si256(in);
+			if (_mm256_testz_si256(mask, mask)) { continue; }
+
+			auto idx = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_cvttps_epi32(v), stride), _mm256_cvttps_epi32(u));
+			idx = _mm256_and_si256(idx, mask);
+			auto s = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int*)image->mPixels.data(), idx, mask, 4);
+			auto d = _mm256_loadu_si256((const __m256i*)(dst + x));
+			_mm256_storeu_si256((__m256i*)(dst + x), Blend8(s, d));
+		}
+		RotateScalar(cmd, dst, x, x1, ub, vb);
+	}
+#endif
+
+	struct Kernel
+	{
+		const char* mName;
+		void (*mAxis)(uint32_t*, const uint32_t*, int);
+		void (*mRotate)(const Command&, uint32_t*, int, int, float, float);
+	};
+
+	static Kernel SelectKernel()
+	{
+		Kernel scalar = { "scalar", AxisScalar, RotateScalar };
+		auto force = std::getenv("SIMPLE2D_SIMD");
+		auto want = [&](const char* name) { return force == nullptr || std::strcmp(force, name) == 0; };
+#ifdef SIMPLE2D_X86
+		if (want("avx2") && __builtin_cpu_supports("avx2")) { return { "avx2", AxisAVX2, RotateAVX2 }; }
+		if (want("sse2")) { return { "sse2", AxisSSE2, RotateSSE2 }; }
+#endif
+		return scalar;
+	}
+
+	static Kernel sKernel = SelectKernel();
+
+	//	Rasterize
+
+	static void RenderTile(Window* window, int tile)
+	{
+		auto cols = (window->mW + kTile - 1) / kTile;
+		auto tx0 = (tile % cols) * kTile, tx1 = std::min(tx0 + kTile, window->mW);
+		auto ty0 = (tile / cols) * kTile, ty1 = std::min(ty0 + kTile, window->mH);
+
+		for (auto y = ty0; y != ty1; ++y)
+		{
+			std::fill(&window->mPixels[(size_t)y * window->mW + tx0],
+					  &window->mPixels[(size_t)y * window->mW + tx1], kClear);
+		}
+
+		for (const auto& cmd : window->mCommands)
+		{
+			auto x0 = std::max(tx0, cmd.mX0), x1 = std::min(tx1, cmd.mX1);
+			auto y0 = std::max(ty0, cmd.mY0), y1 = std::min(ty1, cmd.mY1);
+			if (x0 >= x1 || y0 >= y1) { continue; }
+
+			for (auto y = y0; y != y1; ++y)
+			{
+				auto row = &window->mPixels[(size_t)y * window->mW];
+				if (cmd.mIsAxis)
+				{
+					auto src = &cmd.mImage->mPixels[(size_t)(y - cmd.mTop) * cmd.mImage->mW + (x0 - cmd.mLeft)];
+					sKernel.mAxis(row + x0, src, x1 - x0);
+				}
+				else
+				{
+					sKernel.mRotate(cmd, row, x0, x1, cmd.mUB * (float)y + cmd.mUC,
+													  cmd.mVB * (float)y + cmd.mVC);
+				}
+			}
+		}
+	}
+
+	static void Submit(const Image* image, float fPosX, float fPosY, float fRotation, float fScale)
+	{
+		if (sWindow == nullptr || image == nullptr || image->mW == 0 || image->mH == 0 || fScale <= 0.0f) { return; }
+
+		Command cmd;
+		cmd.mImage = image;
+
+		auto cx = fPosX;
+		auto cy = (float)sWindow->mH - fPosY;	//	y down
+		auto hw = image->mW * 0.5f;
+		auto hh = image->mH * 0.5f;
+
+		cmd.mIsAxis = fRotation == 0.0f && fScale == 1.0f;
+		if (cmd.mIsAxis)
+		{
+			cmd.mLeft = (int)std::floor(cx - hw);
+			cmd.mTop  = (int)std::floor(cy - hh);
+			cmd.mX0 = cmd.mLeft; cmd.mX1 = cmd.mLeft + image->mW;
+			cmd.mY0 = cmd.mTop;  cmd.mY1 = cmd.mTop  + image->mH;
+		}
+		else
+		{
+			//	pixel center (x + 0.5, y + 0.5) -> texel, rotating by -angle in the y-down frame
+			auto rad = fRotation * 3.14159265f / 180.0f;
+			auto c = std::cos(rad) / fScale;
+			auto s = std::sin(rad) / fScale;
+			auto dx = 0.5f - cx;
+			auto dy = 0.5f - cy;
+			cmd.mUA =  c; cmd.mUB = -s; cmd.mUC =  c * dx - s * dy + hw;
+			cmd.mVA =  s; cmd.mVB =  c; cmd.mVC =  s * dx + c * dy + hh;
+
+			auto ex = (std::abs(c) * hw + std::abs(s) * hh) * fScale * fScale;
+			auto ey = (std::abs(s) * hw + std::abs(c) * hh) * fScale * fScale;
+			cmd.mX0 = (int)std::floor(cx - ex); cmd.mX1 = (int)std::ceil(cx + ex) + 1;
+			cmd.mY0 = (int)std::floor(cy - ey); cmd.mY1 = (int)std::ceil(cy + ey) + 1;
+		}
+
+		cmd.mX0 = std::max(cmd.mX0, 0); cmd.mX1 = std::min(cmd.mX1, sWindow->mW);
+		cmd.mY0 = std::max(cmd.mY0, 0); cmd.mY1 = std::min(cmd.mY1, sWindow->mH);
+		if (cmd.mX0 < cmd.mX1 && cmd.mY0 < cmd.mY1)
+		{
+			sWindow->mCommands.push_back(cmd);
+		}
+	}
+
+	//	Window
+
+	// - Parses "SPACE:1.0:2.5,D:1.2:1.4": key name (A-Z or SPACE), down and up time.
+	static std::vector<KeyScript> ParseKeys(const std::string& sKeys)
+	{
+		std::vector<KeyScript> scripts;
+		size_t begin = 0;
+		while (begin < sKeys.size())
+		{
+			auto end = sKeys.find(',', begin);
+			if (end == std::string::npos) { end = sKeys.size(); }
+			auto item = sKeys.substr(begin, end - begin);
+			begin = end + 1;
+
+			char name[16];
+			KeyScript script;
+			if (std::sscanf(item.c_str(), "%15[^:]:%f:%f", name, &script.mDown, &script.mUp) != 3)
+			{
+				std::fprintf(stderr, "Simple2D: bad key script %s\n", item.c_str());
+				continue;
+			}
+			if (std::strcmp(name, "SPACE") == 0)
+			{
+				script.mCode = KEY_SPACE;
+			}
+			else if (name[1] == 0 && name[0] >= 'A' && name[0] <= 'Z')
+			{
+				script.mCode = (KeyCode)(KEY_A + (name[0] - 'A'));
+			}
+			else
+			{
+				std::fprintf(stderr, "Simple2D: unknown key %s\n", name);
+				continue;
+			}
+			scripts.push_back(script);
+		}
+		return scripts;
+	}
+
+	Window* CreateWindow(const std::string& sWindowName, int iWidth, int iHeight)
+	{
+		auto window = new Window();
+		window->mW = iWidth;
+		window->mH = iHeight;
+		window->mFrames = 0;
+		window->mPixels.assign((size_t)iWidth * iHeight, kClear);
+		window->mLast = std::chrono::steady_clock::now();
+
+		auto dump = std::getenv("SIMPLE2D_DUMP");
+		auto frames = std::getenv("SIMPLE2D_FRAMES");
+		auto novsync = std::getenv("SIMPLE2D_NOVSYNC");
+		auto threads = std::getenv("SIMPLE2D_THREADS");
+		auto keys = std::getenv("SIMPLE2D_KEYS");
+		window->mDump = dump != nullptr ? dump : "";
+		window->mMaxFrames = frames != nullptr ? std::atoi(frames) : 0;
+		window->mIsVsync = novsync == nullptr || std::atoi(novsync) == 0;
+
+		auto count = threads != nullptr ? (unsigned int)std::atoi(threads) : std::thread::hardware_concurrency();
+		sPool.Start(std::max(1u, count));
+		sWindow = window;
+		sKeys = ParseKeys(keys != nullptr ? keys : "");
+		return window;
+	}
+
+	void DestroyWindow(Window* pWindow)
+	{
+		sPool.Stop();
+		if (sWindow == pWindow) { sWindow = nullptr; }
+		for (auto image : pWindow->mRetired) { delete image; }
+		delete pWindow;
+	}
+
+	bool ShouldWindowClose(Window* pWindow)
+	{
+		return pWindow->mMaxFrames > 0 && pWindow->mFrames >= (uint64_t)pWindow->mMaxFrames;
+	}
+
+	void RefreshWindowBuffer(Window* pWindow)
+	{
+		auto cols = (pWindow->mW + kTile - 1) / kTile;
+		auto rows = (pWindow->mH + kTile - 1) / kTile;
+		sPool.Run(cols * rows, [pWindow](int tile) { RenderTile(pWindow, tile); });
+		pWindow->mCommands.clear();
+		for (auto image : pWindow->mRetired) { delete image; }
+		pWindow->mRetired.clear();
+
+		if (!pWindow->mDump.empty())
+		{
+			char name[32];
+			std::snprintf(name, sizeof(name), "/frame_%06llu.png", (unsigned long long)pWindow->mFrames);
+			DumpWindowBuffer(pWindow, pWindow->mDump + name);
+		}
+		++pWindow->mFrames;
+
+		if (pWindow->mIsVsync)
+		{
+			pWindow->mLast += std::chrono::microseconds(16667);
+			auto now = std::chrono::steady_clock::now();
+			if (pWindow->mLast > now) { std::this_thread::sleep_until(pWindow->mLast); }
+			else					  { pWindow->mLast = now; }
+		}
+	}
+
+	const unsigned int* GetWindowBuffer(Window* pWindow, int* iWidth, int* iHeight)
+	{
+		*iWidth = pWindow->mW;
+		*iHeight = pWindow->mH;
+		return pWindow->mPixels.data();
+	}
+
+	bool DumpWindowBuffer(Window* pWindow, const std::string& sFileName)
+	{
+		png_image png;
+		std::memset(&png, 0, sizeof(png));
+		png.version = PNG_IMAGE_VERSION;
+		png.width = (png_uint_32)pWindow->mW;
+		png.height = (png_uint_32)pWindow->mH;
+		png.format = PNG_FORMAT_RGBA;
+		return png_image_write_to_file(&png, sFileName.c_str(), 0, pWindow->mPixels.data(), 0, nullptr) != 0;
+	}
+
+	const char* GetBlitKernel()
+	{
+		return sKernel.mName;
+	}
+
+	//	Image
+
+	Image* CreateImage(const std::string& sImageFileName)
+	{
+		png_image png;
+		std::memset(&png, 0, sizeof(png));
+		png.version = PNG_IMAGE_VERSION;
+		if (png_image_begin_read_from_file(&png, sImageFileName.c_str()) == 0)
+		{
+			std::fprintf(stderr, "Simple2D: cannot open %s: %s\n", sImageFileName.c_str(), png.message);
+			return nullptr;
+		}
+
+		png.format = PNG_FORMAT_RGBA;
+		auto image = new Image();
+		image->mW = (int)png.width;
+		image->mH = (int)png.height;
+		image->mPixels.resize((size_t)image->mW * image->mH);
+		if (png_image_finish_read(&png, nullptr, image->mPixels.data(), 0, nullptr) == 0)
+		{
+			std::fprintf(stderr, "Simple2D: cannot decode %s: %s\n", sImageFileName.c_str(), png.message);
+			delete image;
+			return nullptr;
+		}
+		return image;
+	}
+
+	Image* CreateImageFromMemory(const void* pPixels, int iWidth, int iHeight)
+	{
+		auto image = new Image();
+		image->mW = iWidth;
+		image->mH = iHeight;
+		image->mPixels.resize((size_t)iWidth * iHeight);
+		std::memcpy(image->mPixels.data(), pPixels, image->mPixels.size() * sizeof(uint32_t));
+		return image;
+	}
+
+	void DestroyImage(Image* pImage)
+	{
+		delete pImage;
+	}
+
+	void GetImageSize(Image* pImage, int* iWidth, int* iHeight)
+	{
+		*iWidth = pImage != nullptr ? pImage->mW : 0;
+		*iHeight = pImage != nullptr ? pImage->mH : 0;
+	}
+
+	void DrawImage(Image* pImage, float fPosX, float fPosY, float fRotation, float fScale)
+	{
+		Submit(pImage, fPosX, fPosY, fRotation, fScale);
+	}
+
+	//	Font
+
+	static Font* NewFont(FT_Face face, unsigned int iFontSize)
+	{
+		FT_Set_Pixel_Sizes(face, 0, iFontSize);
+
+		auto font = new Font();
+		font->mFace = face;
+		font->mSize = iFontSize;
+		return font;
+	}
+
+	Font* CreateFont(const std::string& sFontFileName, unsigned int iFontSize)
+	{
+		if (sFreeType == nullptr && FT_Init_FreeType(&sFreeType) != 0)
+		{
+			return nullptr;
+		}
+
+		FT_Face face;
+		if (FT_New_Face(sFreeType, sFontFileName.c_str(), 0, &face) != 0)
+		{
+			std::fprintf(stderr, "Simple2D: cannot open %s\n", sFontFileName.c_str());
+			return nullptr;
+		}
+		return NewFont(face, iFontSize);
+	}
+
+	Font* CreateFontFromMemory(const void* pData, size_t iSize, unsigned int iFontSize)
+	{
+		if (sFreeType == nullptr && FT_Init_FreeType(&sFreeType) != 0)
+		{
+			return nullptr;
+		}
+
+		FT_Face face;
+		if (FT_New_Memory_Face(sFreeType, (const FT_Byte*)pData, (FT_Long)iSize, 0, &face) != 0)
+		{
+			std::fprintf(stderr, "Simple2D: cannot load font from memory\n");
+			return nullptr;
+		}
+		return NewFont(face, iFontSize);
+	}
+
+	void DestroyFont(Font* pFont)
+	{
+		if (pFont == nullptr) { return; }
+		for (auto& pair : pFont->mCache) { delete pair.second; }
+		FT_Done_Face(pFont->mFace);
+		delete pFont;
+	}
+
+	// - Renders a string once into a white image whose alpha is the glyph coverage.
+	static Image* RenderString(Font* pFont, const std::string& sStr)
+	{
+		auto face = pFont->mFace;
+		auto ascender = (int)(face->size->metrics.ascender >> 6);
+		auto descender = (int)(face->size->metrics.descender >> 6);
+
+		auto width = 0;
+		for (auto ch : sStr)
+		{
+			if (FT_Load_Char(face, (unsigned char)ch, FT_LOAD_DEFAULT) == 0)
+			{
+				width += (int)(face->glyph->advance.x >> 6);
+			}
+		}
+
+		auto image = new Image();
+		image->mW = std::max(width, 1);
+		image->mH = std::max(ascender - descender, 1);
+		image->mPixels.assign((size_t)image->mW * image->mH, 0x00FFFFFF);
+
+		auto pen = 0;
+		for (auto ch : sStr)
+		{
+			if (FT_Load_Char(face, (unsigned char)ch, FT_LOAD_RENDER) != 0) { continue; }
+
+			auto glyph = face->glyph;
+			auto& bitmap = glyph->bitmap;
+			for (unsigned int gy = 0; gy != bitmap.rows; ++gy)
+			{
+				auto y = ascender - glyph->bitmap_top + (int)gy;
+				if (y < 0 || y >= image->mH) { continue; }
+				for (unsigned int gx = 0; gx != bitmap.width; ++gx)
+				{
+					auto x = pen + glyph->bitmap_left + (int)gx;
+					if (x < 0 || x >= image->mW) { continue; }
+					auto coverage = (uint32_t)bitmap.buffer[gy * bitmap.pitch + gx];
+					auto& pixel = image->mPixels[(size_t)y * image->mW + x];
+					pixel = std::max(pixel >> 24, coverage) << 24 | 0x00FFFFFF;
+				}
+			}
+			pen += (int)(glyph->advance.x >> 6);
+		}
+		return image;
+	}
+
+	void DrawString(Font* pFont, const std::string& sStr, float fPosX, float fPosY, float fRotation, float fScale)
+	{
+		if (pFont == nullptr || sStr.empty()) { return; }
+
+		//	strings such as counters change every frame, keep the cache bounded
+		auto it = pFont->mCache.find(sStr);
+		if (it == pFont->mCache.end())
+		{
+			if (pFont->mCache.size() >= 256)
+			{
+				for (auto& pair : pFont->mCache)
+				{
+					if (sWindow != nullptr) { sWindow->mRetired.push_back(pair.second); }
+					else { delete pair.second; }
+				}
+				pFont->mCache.clear();
+			}
+			it = pFont->mCache.emplace(sStr, RenderString(pFont, sStr)).first;
+		}
+		Submit(it->second, fPosX, fPosY, fRotation, fScale);
+	}
+
+	//	Input, the software window has no keyboard: keys are scripted by SIMPLE2D_KEYS
+
+	bool IsKeyPressed(KeyCode code)
+	{
+		auto time = GetGameTime();
+		for (auto& key : sKeys)
+		{
+			if (key.mCode == code && key.mDown <= time && time < key.mUp) { return true; }
+		}
+		return false;
+	}
+
+	bool IsKeyReleased(KeyCode code)
+	{
+		return !IsKeyPressed(code);
+	}
+
+	float GetGameTime()
+	{
+		std::chrono::duration<float> diff = std::chrono::steady_clock::now() - sStart;
+		return diff.count();
+	}
+}
@@ -0,0 +1,1086 @@
+#include <bit>
+#include <random>
+#include <fstream>
+#include <filesystem>
+#include <benchmark/benchmark.h>
+#include "Game/Game.h"
+#include "Game/Component.h"
+#include "Game/Play.h"
+#include "Game/Flow.h"
+
+//  热点路径微基准, 输出JSON:
+//  ShooterBench --benchmark_out=bench.json --benchmark_out_format=json
+
+namespace {
+    std::vector<Vec2> RandomVecs(size_t count, float range, unsigned seed = 1)
+    {
+        std::mt19937 mt(seed);
+        std::uniform_real_distribution<float> dist(-range, range);
+        std::vector<Vec2> vecs(count);
+        for (auto & v : vecs) { v = Vec2(dist(mt), dist(mt)); }
+        return vecs;
+    }
+
+    struct BenchComp : public Game::Component {
+        float mValue;
+        virtual void OnEnter() override { }
+        virtual void OnLeave() override { }
+        virtual void OnUpdate(float dt) override { mValue += dt; }
+        virtual const std::type_info & GetType() override
+        {
+            return typeid(BenchComp);
+        }
+    };
+
+    struct IdleComp : public Game::Component {
+        virtual void OnEnter() override { }
+        virtual void OnLeave() override { }
+        virtual void OnUpdate(float dt) override { }
+        virtual bool IsTick() override { return false; }
+        virtual const std::type_info & GetType() override
+        {
+            return typeid(IdleComp);
+        }
+    };
+
+    //  预制体之前的子弹生成方式, 每次生成时配置组件
+    struct LegacyBullet : public Game::Component {
+        Vec2 mCoord;
+        virtual void OnEnter() override
+        {
+            mOwner->mTrans->Coord(mCoord);
+            mOwner->mOutDelete = 300;
+
+            auto collision = mOwner->AddComponent<Game::CompCollision>();
+            collision->mRadius = 30;
+            collision->mSelf = (int)Game::CollisionTag::kPlayer | (int)Game::CollisionTag::kBullet;
+            collision->mMask = (int)Game::CollisionTag::kPlayer;
+            collision->mIsFast = true;
+            collision->mLayer = Game::CollisionLayer::kPlayerBullet;
+            collision->mHitFn = std::bind(&LegacyBullet::OnHit, this, std::placeholders::_1);
+
+            auto sprite = mOwner->AddComponent<Game::CompSprite>();
+            sprite->SetClip(Game::FindClip("PlayerBullet"));
+        }
+        void OnHit(Game::CompCollision * comp) { }
+        virtual void OnLeave() override { }
+        virtual void OnUpdate(float dt) override { }
+        virtual const std::type_info & GetType() override
+        {
+            return typeid(LegacyBullet);
+        }
+    };
+
+    //  精灵更新时写入绘制列表
+    DrawList sDraw;
+
+    void InitBulletPrefab()
+    {
+        Game::Ctx()->mDraw = &sDraw;
+        if (Game::Ctx()->mPrefabs.count("PlayerBullet") == 0)
+        {
+            Game::Ctx()->mImages["PlayerBullet"] = Simple2D::CreateImage("PlayerBullet");
+            Game::CreateClip("PlayerBullet", { "PlayerBullet" }, 1.0f, false);
+            Play::Bullet::CreatePrefab("PlayerBullet", 7.5f, 30.5f,
+                    (int)Game::CollisionTag::kPlayer | (int)Game::CollisionTag::kBullet,
+                    (int)Game::CollisionTag::kPlayer, Game::CollisionLayer::kPlayerBullet, true);
+        }
+        Game::Ctx()->mPlay.mRange = Vec2((float)Game::mWindowW, (float)Game::mWindowH);
+    }
+
+    //  无头世界共享的资源, 贴图为空实现
+    const Game::Contex & WorldAssets()
+    {
+        static Game::Contex * sAssets = []
+        {
+            auto assets = new Game::Contex();
+            auto last = Game::BindWorld(assets);
+            Game::LoadAssets();
+            if (assets->mScene == nullptr)
+            {
+                std::string error;
+                assets->mLevel.Load(SHOOTER_CONTENT "/Scenes/Level.txt", error);
+                assets->mScene = &assets->mLevel;
+            }
+            Game::BindWorld(last);
+            return assets;
+        }();
+        return *sAssets;
+    }
+}
+
+//  Math
+static void BM_MathNormal(benchmark::State & state)
+{
+    auto vecs = RandomVecs(state.range(0), 1000);
+    for (auto _ : state)
+    {
+        for (auto & v : vecs) { benchmark::DoNotOptimize(Math::Normal(v)); }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MathNormal)->RangeMultiplier(8)->Range(64, 64 << 10);
+
+static void BM_MathToAngle(benchmark::State & state)
+{
+    auto vecs = RandomVecs(state.range(0), 1000);
+    for (auto _ : state)
+    {
+        for (auto & v : vecs) { benchmark::DoNotOptimize(Math::ToAngle(v)); }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MathToAngle)->RangeMultiplier(8)->Range(64, 64 << 10);
+
+static void BM_MathLimitLength(benchmark::State & state)
+{
+    auto vecs = RandomVecs(state.range(0), 1000);
+    for (auto _ : state)
+    {
+        for (size_t i = 1; i < vecs.size(); ++i)
+        {
+            benchmark::DoNotOptimize(Math::LimitLength(vecs[i - 1], vecs[i], 50));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MathLimitLength)->RangeMultiplier(8)->Range(64, 64 << 10);
+
+static void BM_MathIsContains(benchmark::State & state)
+{
+    auto vecs = RandomVecs(state.range(0), 1000);
+    for (auto _ : state)
+    {
+        for (size_t i = 1; i < vecs.size(); ++i)
+        {
+            benchmark::DoNotOptimize(Math::IsContains(Cir(vecs[i - 1], 20), Cir(vecs[i], 20)));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MathIsContains)->RangeMultiplier(8)->Range(64, 64 << 10);
+
+static void BM_MathIsSweepContains(benchmark::State & state)
+{
+    auto vecs = RandomVecs(state.range(0), 1000);
+    for (auto _ : state)
+    {
+        auto t = 0.0f;
+        for (size_t i = 1; i < vecs.size(); ++i)
+        {
+            benchmark::DoNotOptimize(Math::IsSweepContains(
+                Cir(vecs[i - 1], 20), Vec2(40, 0), Cir(vecs[i], 20), Vec2(), t));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MathIsSweepContains)->RangeMultiplier(8)->Range(64, 64 << 10);
+
+//  Timer
+static void BM_TimerReg(benchmark::State & state)
+{
+    for (auto _ : state)
+    {
+        Timer timer;
+        for (auto i = 0; i != state.range(0); ++i)
+        {
+            timer.Reg((float)i, [] { });
+        }
+        benchmark::DoNotOptimize(timer.mItems.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TimerReg)->RangeMultiplier(10)->Range(10, 100000);
+
+static void BM_TimerDel(benchmark::State & state)
+{
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        Timer timer;
+        std::vector<int> ids;
+        for (auto i = 0; i != state.range(0); ++i)
+        {
+            ids.push_back(timer.Reg((float)i, [] { }));
+        }
+        state.ResumeTiming();
+
+        //  删除一半, O(n)的删除只测有限次数
+        auto step = std::max<size_t>(1, ids.size() / 64);
+        for (size_t i = 0; i < ids.size(); i += step)
+        {
+            timer.Del(ids[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * std::min<int64_t>(state.range(0), 64));
+}
+BENCHMARK(BM_TimerDel)->RangeMultiplier(10)->Range(10, 100000);
+
+static void BM_TimerCall(benchmark::State & state)
+{
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        Timer timer;
+        for (auto i = 0; i != state.range(0); ++i)
+        {
+            timer.Reg((float)i, [] { });
+        }
+        state.ResumeTiming();
+
+        timer.Call((float)state.range(0));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TimerCall)->RangeMultiplier(10)->Range(10, 100000);
+
+//  Script
+namespace {
+    Script::Task SleepLoop(Script::Scheduler & scheduler, float interval, int * count)
+    {
+        for (;;)
+        {
+            ++*count;
+            co_await Script::Sleep(scheduler, interval, 0);
+        }
+    }
+}
+
+//  生成并取消脚本, 池热身后应无分配
+static void BM_ScriptSpawn(benchmark::State & state)
+{
+    Timer timer;
+    Script::Scheduler scheduler;
+    scheduler.Init(&timer);
+    std::vector<Script::Task> tasks(state.range(0));
+    auto count = 0;
+    auto now = 0.0f;
+    uint64_t allocs = 0;
+    for (auto _ : state)
+    {
+        auto start = Memory::AllocCount();
+        for (auto & task : tasks) { task = SleepLoop(scheduler, 1.0f, &count); }
+        for (auto & task : tasks) { task.Reset(); }
+
+        //  取消的脚本在唤醒时释放
+        timer.Call(now += 1.0f);
+        allocs += Memory::AllocCount() - start;
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["allocs"] = benchmark::Counter((double)allocs, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_ScriptSpawn)->RangeMultiplier(10)->Range(100, 10000);
+
+//  每次迭代全部脚本到期并恢复一次
+static void BM_ScriptWake(benchmark::State & state)
+{
+    Timer timer;
+    Script::Scheduler scheduler;
+    scheduler.Init(&timer);
+    auto count = 0;
+    std::vector<Script::Task> tasks;
+    for (auto i = 0; i != state.range(0); ++i)
+    {
+        tasks.push_back(SleepLoop(scheduler, 0.1f, &count));
+    }
+    auto now = 0.0f;
+    for (auto _ : state)
+    {
+        timer.Call(now += 0.1f);
+    }
+    benchmark::DoNotOptimize(count);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ScriptWake)->RangeMultiplier(10)->Range(100, 10000);
+
+//  休眠中的脚本每帧开销, 对照逐帧递减的倒计时
+static void BM_ScriptIdle(benchmark::State & state)
+{
+    Timer timer;
+    Script::Scheduler scheduler;
+    scheduler.Init(&timer);
+    auto count = 0;
+    std::vector<Script::Task> tasks;
+    for (auto i = 0; i != state.range(0); ++i)
+    {
+        tasks.push_back(SleepLoop(scheduler, 1e6f, &count));
+    }
+    auto now = 0.0f;
+    for (auto _ : state)
+    {
+        scheduler.Update();
+        timer.Call(now += 0.016f);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ScriptIdle)->RangeMultiplier(10)->Range(100, 10000);
+
+static void BM_CountdownIdle(benchmark::State & state)
+{
+    std::vector<float> times(state.range(0), 1e6f);
+    auto count = 0;
+    for (auto _ : state)
+    {
+        for (auto & time : times)
+        {
+            time = std::max(0.0f, time - 0.016f);
+            if (time == 0) { ++count; time = 1e6f; }
+        }
+        benchmark::DoNotOptimize(times.data());
+    }
+    benchmark::DoNotOptimize(count);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CountdownIdle)->RangeMultiplier(10)->Range(100, 10000);
+
+//  Beizer
+static void BM_BeizerInit(benchmark::State & state)
+{
+    auto points = RandomVecs(state.range(0), 400);
+    for (auto _ : state)
+    {
+        Beizer beizer;
+        beizer.InitBeizer(points);
+        benchmark::DoNotOptimize(beizer.mSegs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BeizerInit)->RangeMultiplier(4)->Range(4, 1024);
+
+static void BM_BeizerCalc(benchmark::State & state)
+{
+    Beizer beizer;
+    beizer.InitBeizer(RandomVecs(state.range(0), 400));
+    for (auto _ : state)
+    {
+        for (auto i = 0; i != 1000; ++i)
+        {
+            benchmark::DoNotOptimize(beizer.Calc(i * 0.001f));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_BeizerCalc)->RangeMultiplier(4)->Range(4, 1024);
+
+//  碰撞, 密度固定: 场地随数量放大
+static void BM_Collide(benchmark::State & state)
+{
+    auto count = (size_t)state.range(0);
+    auto range = std::sqrt((float)count) * 40;
+    auto coords = RandomVecs(count, range);
+    auto moves  = RandomVecs(count, 20, 2);
+
+    const uint32_t selfs[] = { 0x2, 0x3, 0x4, 0x5 };
+    const uint32_t masks[] = { 0x2, 0x2, 0x4, 0x4 };
+    Collide collide;
+    collide.SetInteract(0, 2, true);
+    collide.SetInteract(0, 3, true);
+    collide.SetInteract(1, 2, true);
+    collide.SetInteract(1, 3, true);
+
+    std::vector<Collide::Body> bodys(count);
+    for (size_t i = 0; i != count; ++i)
+    {
+        auto & body = bodys[i];
+        body.mLayer  = (uint32_t)(i % 4);
+        body.mSelf   = selfs[body.mLayer];
+        body.mMask   = masks[body.mLayer];
+        body.mCoord  = coords[i];
+        body.mRadius = 20;
+        body.mIsFast = body.mLayer == 1;
+        body.mUser   = nullptr;
+        collide.Insert(&body);
+    }
+
+    size_t pairs = 0;
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i != count; ++i)
+        {
+            bodys[i].mCoord = coords[i] + moves[(i + pairs) % count];
+        }
+        pairs += collide.Update().size();
+    }
+    state.counters["pairs"] = benchmark::Counter((double)pairs, benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_Collide)->RangeMultiplier(10)->Range(100, 50000);
+
+//  窄相单对耗时: range(0)形状 0圆 1胶囊 2盒 3混合, range(1) 0逐对 1按8道一批
+namespace {
+    Collide::Rect RandomRect(std::mt19937 & mt, int kind)
+    {
+        std::uniform_real_distribution<float> dist(0, 1);
+        auto angle = dist(mt) * 360;
+        auto axis  = Math::ToVec(angle);
+        kind = kind == 3 ? (int)(dist(mt) * 3) : kind;
+        Collide::Rect rect = { dist(mt) * 200, dist(mt) * 200, 1, 0, 0, 0, 0 };
+        if (kind == 0) { rect.mR = 10 + dist(mt) * 20; }
+        if (kind == 1) { rect.mUX = axis.x; rect.mUY = axis.y; rect.mHX = 10 + dist(mt) * 30; rect.mR = 5 + dist(mt) * 5; }
+        if (kind == 2) { rect.mUX = axis.x; rect.mUY = axis.y; rect.mHX = 10 + dist(mt) * 20; rect.mHY = 10 + dist(mt) * 20; }
+        return rect;
+    }
+}
+
+static void BM_CollidePair(benchmark::State & state)
+{
+    const size_t kShapes = 64, kCandidates = 4096;
+    auto kind = (int)state.range(0);
+    std::mt19937 mt(1);
+    std::vector<Collide::Rect> shapes, candidates;
+    for (size_t i = 0; i != kShapes; ++i)     { shapes.push_back(RandomRect(mt, kind)); }
+    for (size_t i = 0; i != kCandidates; ++i) { candidates.push_back(RandomRect(mt, kind)); }
+
+    std::vector<Collide::Body> bodys(kCandidates);
+    std::vector<Collide::Lanes> lanes(kCandidates / Collide::kLanes, Collide::Lanes());
+    for (size_t i = 0; i != kCandidates; ++i)
+    {
+        bodys[i].mRect = candidates[i];
+        lanes[i / Collide::kLanes].Push(&bodys[i]);
+    }
+
+    size_t hits = 0;
+    for (auto _ : state)
+    {
+        for (auto & shape : shapes)
+        {
+            if (state.range(1) == 0)
+            {
+                for (auto & candidate : candidates)
+                {
+                    auto hit = Collide::IsOverlap(shape, candidate);
+                    benchmark::DoNotOptimize(hit);
+                    hits += hit;
+                }
+            }
+            else
+            {
+                for (auto & lane : lanes)
+                {
+                    auto mask = Collide::Overlap(shape, lane);
+                    benchmark::DoNotOptimize(mask);
+                    hits += std::popcount(mask);
+                }
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kShapes * kCandidates);
+    state.counters["hit"] = (double)hits / ((double)state.iterations() * kShapes * kCandidates);
+}
+BENCHMARK(BM_CollidePair)->ArgsProduct({ { 0, 1, 2, 3 }, { 0, 1 } });
+
+//  同BM_Collide, 高速层为胶囊, 敌方层为盒, 余下为圆
+static void BM_CollideShapes(benchmark::State & state)
+{
+    auto count = (size_t)state.range(0);
+    auto range = std::sqrt((float)count) * 40;
+    auto coords = RandomVecs(count, range);
+    auto moves  = RandomVecs(count, 20, 2);
+
+    const uint32_t selfs[] = { 0x2, 0x3, 0x4, 0x5 };
+    const uint32_t masks[] = { 0x2, 0x2, 0x4, 0x4 };
+    Collide collide;
+    collide.SetInteract(0, 2, true);
+    collide.SetInteract(0, 3, true);
+    collide.SetInteract(1, 2, true);
+    collide.SetInteract(1, 3, true);
+
+    std::vector<Collide::Body> bodys(count);
+    for (size_t i = 0; i != count; ++i)
+    {
+        auto & body = bodys[i];
+        body.mLayer  = (uint32_t)(i % 4);
+        body.mSelf   = selfs[body.mLayer];
+        body.mMask   = masks[body.mLayer];
+        body.mCoord  = coords[i];
+        body.mRadius = 20;
+        body.mIsFast = body.mLayer == 1;
+        body.mAxis   = Math::ToVec((float)i);
+        body.mUser   = nullptr;
+        if (body.mLayer == 1) { body.mShape = Collide::Shape::kCapsule; body.mRadius = 7.5f; body.mHalf = Vec2(30, 0); }
+        if (body.mLayer == 2) { body.mShape = Collide::Shape::kBox;     body.mRadius = 4;    body.mHalf = Vec2(21, 15); }
+        collide.Insert(&body);
+    }
+
+    size_t pairs = 0, tested = 0;
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i != count; ++i)
+        {
+            bodys[i].mCoord = coords[i] + moves[(i + pairs) % count];
+        }
+        pairs += collide.Update().size();
+        tested += collide.mTested;
+    }
+    state.counters["pairs"]  = benchmark::Counter((double)pairs, benchmark::Counter::kAvgIterations);
+    state.counters["tested"] = benchmark::Counter((double)tested, benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_CollideShapes)->RangeMultiplier(10)->Range(100, 50000);
+
+//  空间查询: range(0)个碰撞体分4层, 每次迭代10k次查询, 过滤2层
+namespace {
+    const size_t   kQueryCount  = 10000;
+    const uint32_t kQueryLayers = 0x3;
+
+    struct QueryWorld {
+        Collide mCollide;
+        std::vector<Collide::Body> mBodys;
+        std::vector<Vec2> mCoords;
+        float mRange;
+
+        QueryWorld(size_t count)
+        {
+            mRange = std::sqrt((float)count) * 40;
+            auto coords = RandomVecs(count, mRange);
+            mBodys.resize(count);
+            for (size_t i = 0; i != count; ++i)
+            {
+                auto & body = mBodys[i];
+                body = Collide::Body();
+                body.mLayer  = (uint32_t)(i % 4);
+                body.mCoord  = coords[i];
+                body.mRadius = 20;
+                mCollide.Insert(&body);
+            }
+            mCollide.Update();
+            mCoords = RandomVecs(kQueryCount, mRange, 3);
+        }
+    };
+}
+
+//  基准线: 逐个遍历碰撞体
+static void BM_QueryScan(benchmark::State & state)
+{
+    QueryWorld world(state.range(0));
+    Collide::Body * out[64];
+    size_t found = 0;
+    for (auto _ : state)
+    {
+        for (auto & coord : world.mCoords)
+        {
+            size_t count = 0;
+            Cir cir(coord, 50);
+            for (auto & layer : world.mCollide.mLayers)
+            {
+                for (auto body : layer)
+                {
+                    if ((kQueryLayers & (1u << body->mLayer)) != 0 && count != 64
+                        && Math::IsContains(cir, Cir(body->mCoord, body->mRadius)))
+                    {
+                        out[count++] = body;
+                    }
+                }
+            }
+            found += count;
+        }
+    }
+    state.counters["found"] = benchmark::Counter((double)found, benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * kQueryCount);
+}
+BENCHMARK(BM_QueryScan)->Arg(1000)->Arg(10000);
+
+static void BM_QueryOverlap(benchmark::State & state)
+{
+    QueryWorld world(state.range(0));
+    Collide::Body * out[64];
+    size_t found = 0;
+    for (auto _ : state)
+    {
+        for (auto & coord : world.mCoords)
+        {
+            found += world.mCollide.Overlap(Cir(coord, 50), kQueryLayers, out, 64);
+        }
+    }
+    state.counters["found"] = benchmark::Counter((double)found, benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * kQueryCount);
+}
+BENCHMARK(BM_QueryOverlap)->Arg(1000)->Arg(10000);
+
+static void BM_QueryRect(benchmark::State & state)
+{
+    QueryWorld world(state.range(0));
+    Collide::Body * out[64];
+    size_t found = 0;
+    for (auto _ : state)
+    {
+        for (auto & coord : world.mCoords)
+        {
+            found += world.mCollide.Overlap(coord - Vec2(50), coord + Vec2(50), kQueryLayers, out, 64);
+        }
+    }
+    state.counters["found"] = benchmark::Counter((double)found, benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * kQueryCount);
+}
+BENCHMARK(BM_QueryRect)->Arg(1000)->Arg(10000);
+
+//  射线长200, 方向随机
+static void BM_QueryRaycast(benchmark::State & state)
+{
+    QueryWorld world(state.range(0));
+    auto dirs = RandomVecs(kQueryCount, 1, 4);
+    for (auto & dir : dirs) { dir = Math::Normal(dir); }
+
+    size_t found = 0;
+    for (auto _ : state)
+    {
+        Collide::Hit hit;
+        for (size_t i = 0; i != kQueryCount; ++i)
+        {
+            found += world.mCollide.Raycast(world.mCoords[i], dirs[i], 200, kQueryLayers, hit);
+        }
+    }
+    state.counters["found"] = benchmark::Counter((double)found, benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * kQueryCount);
+}
+BENCHMARK(BM_QueryRaycast)->Arg(1000)->Arg(10000);
+
+//  最近4个
+static void BM_QueryNearest(benchmark::State & state)
+{
+    QueryWorld world(state.range(0));
+    Collide::Hit out[4];
+    size_t found = 0;
+    for (auto _ : state)
+    {
+        for (auto & coord : world.mCoords)
+        {
+            found += world.mCollide.Nearest(coord, kQueryLayers, out, 4);
+        }
+    }
+    state.counters["found"] = benchmark::Counter((double)found, benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations() * kQueryCount);
+}
+BENCHMARK(BM_QueryNearest)->Arg(1000)->Arg(10000);
+
+//  流场: 800x600场地, 20像素一格, 目标每帧换格强制重算
+static void BM_FlowUpdate(benchmark::State & state)
+{
+    Flow flow;
+    flow.Init(Vec2(800, 600), 20);
+    auto goals = RandomVecs(64, 300, 5);
+
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        auto & goal = goals[i++ % goals.size()];
+        benchmark::DoNotOptimize(flow.Update(goal + Vec2(400, 300)));
+    }
+    state.SetItemsProcessed(state.iterations() * flow.Cols() * flow.Rows());
+}
+BENCHMARK(BM_FlowUpdate);
+
+//  转向range(0)个代理, 流场不变
+static void BM_FlowSteer(benchmark::State & state)
+{
+    Flow flow;
+    flow.Init(Vec2(800, 600), 40);
+    flow.Update(Vec2(200, 300));
+
+    Flow::Agents agents;
+    for (auto & coord : RandomVecs(state.range(0), 300, 6))
+    {
+        agents.Append(coord + Vec2(400, 300));
+    }
+
+    for (auto _ : state)
+    {
+        flow.Steer(agents, 150, 5, 4, 1.0f / 60);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FlowSteer)->RangeMultiplier(10)->Range(100, 100000);
+
+//  Transform: range(0)棵树, 每棵根节点挂3个炮台, 炮台各挂1个特效
+//  range(1)为每帧移动的根节点百分比, 0时整棵树静止
+static void BM_TransformUpdate(benchmark::State & state)
+{
+    std::vector<Game::CompTransform *> roots, nodes;
+    for (auto i = 0; i != state.range(0); ++i)
+    {
+        auto root = new Game::CompTransform();
+        root->Coord(Vec2((float)i, 0));
+        roots.push_back(root);
+        nodes.push_back(root);
+        for (auto j = 0; j != 3; ++j)
+        {
+            auto turret = new Game::CompTransform();
+            turret->Coord(Vec2(40, 0));
+            turret->Angle(120.0f * j);
+            turret->Parent(root);
+            auto effect = new Game::CompTransform();
+            effect->Coord(Vec2(10, 0));
+            effect->Parent(turret);
+            nodes.push_back(turret);
+            nodes.push_back(effect);
+        }
+    }
+    Game::UpdateTransform();
+
+    auto moving = roots.size() * state.range(1) / 100;
+    auto angle = 0.0f;
+    for (auto _ : state)
+    {
+        angle += 1.0f;
+        for (size_t i = 0; i != moving; ++i) { roots[i]->Angle(angle); }
+        Game::UpdateTransform();
+        benchmark::DoNotOptimize(nodes.back()->Coord());
+    }
+    state.SetItemsProcessed(state.iterations() * nodes.size());
+
+    for (auto node : nodes) { delete node; }
+    Game::Ctx()->mPlay.mHierarchy.clear();
+    Game::Ctx()->mPlay.mHierarchyDirty.clear();
+}
+BENCHMARK(BM_TransformUpdate)->ArgsProduct({ { 100, 1000, 10000 }, { 0, 10, 100 } });
+
+//  Actor生命周期: AppendActor -> UpdateActor -> DeleteActor
+static void BM_ActorLifecycle(benchmark::State & state)
+{
+    Game::Ctx()->mPlay.mRange = Vec2((float)Game::mWindowW, (float)Game::mWindowH);
+
+    std::vector<Game::Actor *> actors(state.range(0));
+    for (auto _ : state)
+    {
+        for (auto & actor : actors)
+        {
+            actor = Game::AppendActor();
+            actor->AddComponent<BenchComp>();
+        }
+        Game::UpdateActor();
+
+        for (auto actor : actors)
+        {
+            Game::DeleteActor(actor);
+        }
+        Game::UpdateActor();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ActorLifecycle)->RangeMultiplier(10)->Range(10, 10000);
+
+//  UpdateActor: 固定100个更新组件, 另加range(0)个静止Actor
+static void BM_UpdateIdle(benchmark::State & state)
+{
+    Game::Ctx()->mPlay.mRange = Vec2((float)Game::mWindowW, (float)Game::mWindowH);
+
+    std::vector<Game::Actor *> actors;
+    for (auto i = 0; i != 100; ++i)
+    {
+        actors.push_back(Game::AppendActor());
+        actors.back()->AddComponent<BenchComp>();
+    }
+    for (auto i = 0; i != state.range(0); ++i)
+    {
+        actors.push_back(Game::AppendActor());
+        actors.back()->AddComponent<IdleComp>();
+    }
+    Game::UpdateActor();
+
+    for (auto _ : state)
+    {
+        Game::UpdateActor();
+    }
+
+    auto & counts = Game::Ctx()->mPlay.mTickCounts;
+    state.counters["tick"]  = counts[typeid(BenchComp)].mTick;
+    state.counters["sleep"] = counts[typeid(IdleComp)].mSleep;
+
+    for (auto actor : actors)
+    {
+        Game::DeleteActor(actor);
+    }
+    Game::UpdateActor();
+}
+BENCHMARK(BM_UpdateIdle)->RangeMultiplier(10)->Range(10, 100000);
+
+//  子弹生成吞吐: 逐个配置组件 vs 预制体批量复制, 包含进入场景
+static void BM_SpawnLegacy(benchmark::State & state)
+{
+    InitBulletPrefab();
+
+    auto coords = RandomVecs(state.range(0), 500);
+    std::vector<Game::Actor *> actors(state.range(0));
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i != actors.size(); ++i)
+        {
+            actors[i] = Game::AppendActor();
+            actors[i]->AddComponent<LegacyBullet>()->mCoord = coords[i];
+        }
+        Game::UpdateActor();
+
+        state.PauseTiming();
+        for (auto actor : actors) { Game::DeleteActor(actor); }
+        Game::UpdateActor();
+        sDraw.Clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SpawnLegacy)->RangeMultiplier(10)->Range(100, 10000);
+
+static void BM_SpawnPrefab(benchmark::State & state)
+{
+    InitBulletPrefab();
+
+    auto prefab = Game::FindPrefab("PlayerBullet");
+    auto coords = RandomVecs(state.range(0), 500);
+    std::vector<Game::Actor *> actors(state.range(0));
+    for (auto _ : state)
+    {
+        Game::Spawn(prefab, coords.data(), coords.size(), actors.data());
+        Game::UpdateActor();
+
+        state.PauseTiming();
+        for (auto actor : actors) { Game::DeleteActor(actor); }
+        Game::UpdateActor();
+        sDraw.Clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SpawnPrefab)->RangeMultiplier(10)->Range(100, 10000);
+
+//  多世界: range(0)个世界分给range(1)个线程, 每次迭代各推进60帧, 统计总模拟帧每秒
+static void BM_WorldStep(benchmark::State & state)
+{
+    const uint kTicks = 60;
+    std::vector<Game::Contex *> worlds;
+    for (auto i = 0; i != state.range(0); ++i)
+    {
+        worlds.push_back(Game::CreateWorld(WorldAssets(), i + 1, 1 / 60.0f));
+    }
+
+    //  首帧菜单进场, 之后按住开火开始战斗
+    Game::StepWorlds(worlds.data(), worlds.size(), 1, 1);
+    for (auto world : worlds)
+    {
+        world->mInputs.Push({ (uint)Game::InputEnum::kFire, true, world->mLastTime });
+    }
+
+    for (auto _ : state)
+    {
+        Game::StepWorlds(worlds.data(), worlds.size(), kTicks, (uint)state.range(1));
+    }
+    state.SetItemsProcessed(state.iterations() * worlds.size() * kTicks);
+
+    for (auto world : worlds) { Game::DestroyWorld(world); }
+}
+//  世界随时间变重(敌群逐波累积), 固定迭代次数使各组合模拟相同的时段
+BENCHMARK(BM_WorldStep)->ArgsProduct({ { 16, 64, 256 }, { 1, 2, 4, 8 } })->Iterations(10)
+                       ->UseRealTime()->Unit(benchmark::kMillisecond);
+
+//  外部驱动: 每步一个动作, 写观测与奖励, 结束的世界暂停计时后重建
+static void BM_StepBatch(benchmark::State & state)
+{
+    auto count = (size_t)state.range(0);
+    auto ticks = (uint)state.range(1);
+    std::vector<Game::Contex *> worlds;
+    for (size_t i = 0; i != count; ++i)
+    {
+        worlds.push_back(Game::CreateWorld(WorldAssets(), (uint)i + 1, 1 / 60.0f));
+    }
+    std::vector<uint> actions(count, (uint)Game::InputEnum::kFire);
+    std::vector<float> obs(count * Game::Observe::kSize);
+    std::vector<Game::StepResult> results(count);
+
+    //  开火并每16步换一个方向
+    const uint kDirs[] = { 0, (uint)Game::InputEnum::kDirL, (uint)Game::InputEnum::kDirR,
+                              (uint)Game::InputEnum::kDirU, (uint)Game::InputEnum::kDirD };
+    uint step = 0;
+    int64_t episodes = 0;
+    float reward = 0;
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i != count; ++i)
+        {
+            actions[i] = (uint)Game::InputEnum::kFire | kDirs[(step / 16 + i) % 5];
+        }
+        Game::StepBatch(worlds.data(), count, actions.data(), ticks, obs.data(), results.data(), 1);
+        ++step;
+
+        for (size_t i = 0; i != count; ++i)
+        {
+            reward += results[i].mReward;
+            if (results[i].mIsDone)
+            {
+                state.PauseTiming();
+                Game::DestroyWorld(worlds[i]);
+                worlds[i] = Game::CreateWorld(WorldAssets(), (uint)(count + ++episodes), 1 / 60.0f);
+                state.ResumeTiming();
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count * ticks);
+    state.counters["episodes"] = (double)episodes;
+    state.counters["reward"]   = benchmark::Counter(reward, benchmark::Counter::kAvgIterations);
+
+    for (auto world : worlds) { Game::DestroyWorld(world); }
+}
+BENCHMARK(BM_StepBatch)->ArgsProduct({ { 16, 256 }, { 1, 4 } })->Iterations(200)
+                       ->Unit(benchmark::kMillisecond);
+
+//  只写观测: 最近邻查询与逐项写入
+static void BM_ObserveWorld(benchmark::State & state)
+{
+    auto world = Game::CreateWorld(WorldAssets(), 1, 1 / 60.0f);
+    uint fire = (uint)Game::InputEnum::kFire;
+    std::vector<float> obs(Game::Observe::kSize);
+    Game::StepResult result;
+    for (auto i = 0; i != 120; ++i)
+    {
+        Game::StepBatch(&world, 1, &fire, 1, obs.data(), &result, 1);
+    }
+
+    auto allocs = Memory::AllocCount();
+    for (auto _ : state)
+    {
+        Game::ObserveWorld(world, obs.data());
+        benchmark::DoNotOptimize(obs.data());
+    }
+    state.counters["allocs"] = benchmark::Counter((double)(Memory::AllocCount() - allocs), benchmark::Counter::kAvgIterations);
+
+    Game::DestroyWorld(world);
+}
+BENCHMARK(BM_ObserveWorld);
+
+//  关卡: count个Actor的网格编译到临时文件, 返回路径
+static std::string CompileGridScene(size_t count)
+{
+    auto side = (size_t)std::ceil(std::sqrt((double)count));
+    auto text = "boss 20 100 0.1 50 0.07\n"
+                "path 0 0 800 600\n"
+                "prefab Rock PlayerBullet enemy circle 7.5\n"
+                "grid Rock 0 0 8000 6000 " + std::to_string(side) + " " + std::to_string(count / side) + "\n";
+
+    std::vector<uint8_t> bytes;
+    std::string error;
+    Scene::Compile(text, bytes, error);
+    auto path = (std::filesystem::temp_directory_path() / ("ShooterBench" + std::to_string(count) + ".scene")).string();
+    std::ofstream(path, std::ios::binary).write((const char *)bytes.data(), (std::streamsize)bytes.size());
+    return path;
+}
+
+//  映射并校验, 不解析也不复制Actor数据
+static void BM_SceneOpen(benchmark::State & state)
+{
+    auto path = CompileGridScene(state.range(0));
+    for (auto _ : state)
+    {
+        Scene scene;
+        benchmark::DoNotOptimize(scene.Open(path));
+        benchmark::DoNotOptimize(scene.mCoords.mData);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_SceneOpen)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMicrosecond);
+
+//  映射后按段批量生成并进入场景, 时间主要在逐个复制组件与进场
+static void BM_SceneSpawn(benchmark::State & state)
+{
+    InitBulletPrefab();
+
+    auto path = CompileGridScene(state.range(0));
+    Scene scene;
+    scene.Open(path);
+    if (Game::Ctx()->mPrefabs.count("Rock") == 0) { Play::CreatePrefabs(scene); }
+
+    std::vector<Game::Actor *> actors(scene.mCoords.Size());
+    for (auto _ : state)
+    {
+        for (auto & run : scene.mRuns)
+        {
+            Game::Spawn(Game::FindPrefab(scene.mPrefabs[run.mPrefab].mName),
+                        &scene.mCoords[run.mFirst], run.mCount, actors.data() + run.mFirst);
+        }
+        Game::UpdateActor();
+
+        state.PauseTiming();
+        for (auto actor : actors) { Game::DeleteActor(actor); }
+        Game::UpdateActor();
+        sDraw.Clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * actors.size());
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_SceneSpawn)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMillisecond);
+
+//  状态机敌人: 关卡中的状态表, 敌人随机分布在各状态与舞台上, 每次迭代推进一帧
+static void BM_BehaviorUpdate(benchmark::State & state)
+{
+    auto & scene = *WorldAssets().mScene;
+    auto n = (size_t)state.range(0);
+    auto coords = RandomVecs(n, 400);
+    std::mt19937 mt(1);
+
+    Behavior behavior;
+    behavior.Init(scene.mStates.mData, scene.mStates.Size(), scene.mTrans.mData);
+    Behavior::Agents agents;
+    for (size_t i = 0; i != n; ++i)
+    {
+        auto s = (uint32_t)(mt() % scene.mStates.Size());
+        agents.Append(coords[i] + Vec2(400, 300), (float)(mt() % 360), 16, 3, s, 0);
+        behavior.Enter(agents, i, s);
+        agents.mCD[i] *= (float)(mt() % 100) / 100;
+    }
+
+    std::vector<Behavior::Shot> shots;
+    size_t fired = 0;
+    auto target = Vec2(240, 300);
+    for (auto _ : state)
+    {
+        shots.clear();
+        behavior.Update(agents, target, 1 / 60.0f, shots);
+        fired += shots.size();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.counters["shots"] = benchmark::Counter((double)fired, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_BehaviorUpdate)->RangeMultiplier(10)->Range(1000, 100000);
+
+//  稳态粒子数: 寿命1秒, 每帧补发1/60, 覆盖Update + Render
+static void BM_Particle(benchmark::State & state)
+{
+    auto n = (uint32_t)state.range(0);
+    auto coords = RandomVecs(64, 400);
+
+    Particle::Emitter emitter = { };
+    for (auto i = 0; i != 4; ++i) { emitter.mFrames.push_back(Simple2D::CreateImage("Particle")); }
+    emitter.mAnchor   = Vec2(0.5f, 0.5f);
+    emitter.mInterval = 0.25f;
+    emitter.mLife     = 1.0f;
+    emitter.mSpread   = 200;
+    emitter.mCount    = n / 60;
+
+    Particle particle;
+    particle.SetEmitter(0, emitter);
+    auto range = Vec2((float)Game::mWindowW, (float)Game::mWindowH);
+    size_t emit = 0;
+    auto step = [&]
+    {
+        particle.Emit(0, coords[emit++ % coords.size()] + range * 0.5f);
+        particle.Update(1 / 60.0f);
+    };
+    for (auto i = 0; i != 60; ++i) { step(); }
+
+    size_t drawn = 0;
+    for (auto _ : state)
+    {
+        sDraw.Clear();
+        step();
+        particle.Render(range, sDraw);
+        drawn += sDraw.mCommands.size();
+    }
+    sDraw.Clear();
+    for (auto image : emitter.mFrames) { Simple2D::DestroyImage(image); }
+    state.SetItemsProcessed(state.iterations() * particle.Count());
+    state.counters["live"]  = (double)particle.Count();
+    state.counters["drawn"] = benchmark::Counter((double)drawn, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_Particle)->Arg(50000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,78 @@
+#include "Simple2D.h"
+#include <chrono>
+
+//  无窗口的Simple2D空实现, 供基准测试等无渲染场景链接
+namespace Simple2D
+{
+	class Window { public: bool mClose; };
+	class Image  { public: int mW, mH; };
+	class Font   { public: unsigned int mSize; };
+
+	static auto sStart = std::chrono::steady_clock::now();
+
+	Window* CreateWindow(const std::string& sWindowName, int iWidth, int iHeight)
+	{
+		return new Window{ false };
+	}
+
+	void DestroyWindow(Window* pWindow)
+	{
+		delete pWindow;
+	}
+
+	bool ShouldWindowClose(Window* pWindow)
+	{
+		return pWindow->mClose;
+	}
+
+	void RefreshWindowBuffer(Window* pWindow)
+	{ }
+
+	Image* CreateImage(const std::string& sImageFileName)
+	{
+		return new Image{ 64, 64 };
+	}
+
+	void DestroyImage(Image* pImage)
+	{
+		delete pImage;
+	}
+
+	void GetImageSize(Image* pImage, int* iWidth, int* iHeight)
+	{
+		*iWidth  = pImage->mW;
+		*iHeight = pImage->mH;
+	}
+
+	void DrawImage(Image* pImage, float fPosX, float fPosY, float fRotation, float fScale)
+	{ }
+
+	Font* CreateFont(const std::string& sFontFileName, unsigned int iFontSize)
+	{
+		return new Font{ iFontSize };
+	}
+
+	void DestroyFont(Font* pFont)
+	{
+		delete pFont;
+	}
+
+	void DrawString(Font* pFont, const std::string& sStr, float fPosX, float fPosY, float fRotation, float fScale)
+	{ }
+
+	bool IsKeyPressed(KeyCode code)
+	{
+		return false;
+	}
+
+	bool IsKeyReleased(KeyCode code)
+	{
+		return false;
+	}
+
+	float GetGameTime()
+	{
+		std::chrono::duration<float> diff = std::chrono::steady_clock::now() - sStart;
+		return diff.count();
+	}
+}
@@ -0,0 +1,120 @@
+#include "Archive.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+bool Archive::Open(const std::string & path)
+{
+    Close();
+
+#ifdef _WIN32
+    auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { return false; }
+
+    LARGE_INTEGER size;
+    auto mapping = GetFileSizeEx(file, &size)
+                 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    CloseHandle(file);
+    if (mapping == nullptr) { return false; }
+
+    auto data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr) { CloseHandle(mapping); return false; }
+
+    mData   = (const uint8_t *)data;
+    mSize   = (size_t)size.QuadPart;
+    mHandle = mapping;
+#else
+    auto file = open(path.c_str(), O_RDONLY);
+    if (file < 0) { return false; }
+
+    struct stat st;
+    auto data = fstat(file, &st) == 0 && st.st_size > 0
+              ? mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, file, 0) : MAP_FAILED;
+    close(file);
+    if (data == MAP_FAILED) { return false; }
+
+    mData = (const uint8_t *)data;
+    mSize = (size_t)st.st_size;
+#endif
+    mIsMapped = true;
+    return Validate();
+}
+
+bool Archive::Open(const void * data, size_t size)
+{
+    Close();
+    mData = (const uint8_t *)data;
+    mSize = size;
+    return mData != nullptr && Validate();
+}
+
+//  校验头和目录, 失败时关闭
+bool Archive::Validate()
+{
+    auto header = (const Header *)mData;
+    auto valid = mSize >= sizeof(Header)
+              && header->mMagic == kMagic && header->mVersion == kVersion
+              && mSize >= sizeof(Header) + (size_t)header->mCount * sizeof(Entry);
+    for (uint32_t i = 0; valid && i != header->mCount; ++i)
+    {
+        auto & entry = At(i);
+        valid = entry.mOffset <= mSize && entry.mSize <= mSize - entry.mOffset
+             && std::memchr(entry.mName, 0, sizeof(entry.mName)) != nullptr;
+    }
+    if (!valid) { Close(); }
+    return valid;
+}
+
+void Archive::Close()
+{
+    if (mData == nullptr) { return; }
+
+    if (mIsMapped)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(mData);
+        CloseHandle((HANDLE)mHandle);
+#else
+        munmap((void *)mData, mSize);
+#endif
+    }
+    mData     = nullptr;
+    mSize     = 0;
+    mHandle   = nullptr;
+    mIsMapped = false;
+}
+
+std::vector<uint8_t> Archive::Build(std::vector<Item> & items)
+{
+    auto align = [] (uint64_t v) { return (v + kAlign - 1) / kAlign * kAlign; };
+    auto offset = align(sizeof(Header) + items.size() * sizeof(Entry));
+    for (auto & item : items)
+    {
+        item.mEntry.mOffset = offset;
+        item.mEntry.mSize   = item.mData.size();
+        offset = align(offset + item.mData.size());
+    }
+
+    std::vector<uint8_t> bytes((size_t)offset, 0);
+    Header header = { kMagic, kVersion, (uint32_t)items.size(), 0 };
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    for (size_t i = 0; i != items.size(); ++i)
+    {
+        auto & item = items[i];
+        std::memcpy(bytes.data() + sizeof(Header) + i * sizeof(Entry), &item.mEntry, sizeof(Entry));
+        if (!item.mData.empty())
+        {
+            std::memcpy(bytes.data() + item.mEntry.mOffset, item.mData.data(), item.mData.size());
+        }
+    }
+    return bytes;
+}
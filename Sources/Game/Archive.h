@@ -0,0 +1,115 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+//  资源包: 头 + 目录 + 16字节对齐的数据, 整体映射到内存只读访问
+//  贴图为预解码的RGBA8(行自上而下), 字体为原始文件, 表为定长记录数组(关卡)
+class Archive {
+public:
+    static const uint32_t kMagic   = 0x4B415053;    //  "SPAK"
+    static const uint32_t kVersion = 1;
+    static const uint32_t kAlign   = 16;
+
+    enum class Kind : uint32_t {
+        kImage,
+        kFont,
+        kTable,     //  mWidth为记录字节数, mHeight为记录数
+    };
+
+    struct Header {
+        uint32_t mMagic;
+        uint32_t mVersion;
+        uint32_t mCount;
+        uint32_t mPad;
+    };
+
+    struct Entry {
+        char     mName[32];
+        Kind     mKind;
+        uint32_t mWidth;
+        uint32_t mHeight;
+        uint32_t mPad;
+        uint64_t mOffset;   //  相对文件头
+        uint64_t mSize;
+    };
+
+    //  打包输入, mOffset与mSize由Build填写
+    struct Item {
+        Entry                mEntry;
+        std::vector<uint8_t> mData;
+    };
+
+    //  生成资源包字节流, 离线工具与内存中编译的关卡使用
+    static std::vector<uint8_t> Build(std::vector<Item> & items);
+
+    Archive() : mData(nullptr), mSize(0), mHandle(nullptr), mIsMapped(false)
+    { }
+
+    ~Archive()
+    {
+        Close();
+    }
+
+    bool Open(const std::string & path);
+    //  访问调用方持有的内存, 关闭时不释放
+    bool Open(const void * data, size_t size);
+    void Close();
+
+    bool IsOpen() const
+    {
+        return mData != nullptr;
+    }
+
+    uint32_t Count() const
+    {
+        return ((const Header *)mData)->mCount;
+    }
+
+    const Entry & At(uint32_t index) const
+    {
+        return ((const Entry *)(mData + sizeof(Header)))[index];
+    }
+
+    const Entry * Find(const std::string & name) const
+    {
+        for (uint32_t i = 0; i != Count(); ++i)
+        {
+            if (name == At(i).mName) { return &At(i); }
+        }
+        return nullptr;
+    }
+
+    const void * Data(const Entry & entry) const
+    {
+        return mData + entry.mOffset;
+    }
+
+    //  表条目按记录类型访问, 类型大小或条目不符时返回空
+    template <typename T>
+    const T * Table(const std::string & name, uint32_t & count) const
+    {
+        auto entry = Find(name);
+        count = 0;
+        if (entry == nullptr || entry->mKind != Kind::kTable || entry->mWidth != sizeof(T)
+            || entry->mSize != (uint64_t)entry->mWidth * entry->mHeight)
+        {
+            return nullptr;
+        }
+        count = entry->mHeight;
+        return (const T *)Data(*entry);
+    }
+
+private:
+    Archive(const Archive &) = delete;
+    Archive & operator=(const Archive &) = delete;
+
+    bool Validate();
+
+    const uint8_t * mData;
+    size_t          mSize;
+    void *          mHandle;    //  平台相关的映射句柄
+    bool            mIsMapped;
+};
@@ -0,0 +1,335 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "Math.h"
+
+//  表驱动的敌人状态机: 状态的移动, 旋转, 开火与转移条件都是数据
+//  每帧按状态分桶, 同一状态的敌人在SoA数组上成批处理, 不经虚函数
+//  状态表与转移表可直接指向映射的关卡数据, 缓冲热身后不再分配
+class Behavior {
+public:
+    enum class Move : uint32_t {
+        kHold,      //  原地
+        kChase,     //  朝目标
+        kFlee,      //  背离目标
+        kOrbit,     //  绕目标, mParam为半径
+        kDrift,     //  沿朝向直行, 配合旋转走弧线
+        kCount,
+    };
+
+    enum class Cond : uint32_t {
+        kAfter,     //  进入本状态已过mValue秒
+        kNear,      //  与目标距离小于mValue
+        kFar,       //  与目标距离大于mValue
+        kHurt,      //  血量低于mValue
+        kCount,
+    };
+
+    //  状态, 转移为mTrans[mFirst, mFirst + mCount), 按顺序先满足者生效
+    struct State {
+        Move     mMove;
+        float    mSpeed;        //  像素每秒
+        float    mParam;
+        float    mSpin;         //  朝向角速度, 度每秒, 非0时朝向不再跟随速度
+        float    mFireCD;       //  开火间隔, 0不开火
+        uint32_t mAim;          //  1瞄准目标, 0沿朝向
+        uint32_t mFirst;
+        uint32_t mCount;
+    };
+
+    struct Trans {
+        uint32_t mTo;           //  目标状态在状态表中的下标
+        Cond     mCond;
+        float    mValue;
+        uint32_t mPad;
+    };
+
+    //  本帧的开火请求, 子弹由调用方生成
+    struct Shot {
+        Vec2 mCoord;
+        Vec2 mDir;
+    };
+
+    //  敌人, SoA布局
+    struct Agents {
+        std::vector<float>    mX,  mY;      //  位置
+        std::vector<float>    mVX, mVY;     //  速度
+        std::vector<float>    mDX, mDY;     //  朝向, 单位向量, 循环内不做三角函数
+        std::vector<float>    mTime;        //  进入当前状态以来的时间
+        std::vector<float>    mCD;          //  距下次开火
+        std::vector<float>    mRadius;      //  碰撞半径
+        std::vector<int32_t>  mHp;
+        std::vector<uint32_t> mState;       //  当前状态
+        std::vector<uint32_t> mKind;        //  调用方的类型, 决定外观
+
+        size_t Size() const { return mX.size(); }
+
+        void Append(const Vec2 & coord, float angle, float radius, int32_t hp, uint32_t state, uint32_t kind)
+        {
+            mX.push_back(coord.x);  mY.push_back(coord.y);
+            mVX.push_back(0);       mVY.push_back(0);
+            auto dir = Math::ToVec(angle);
+            mDX.push_back(dir.x);   mDY.push_back(dir.y);
+            mTime.push_back(0);
+            mCD.push_back(0);
+            mRadius.push_back(radius);
+            mHp.push_back(hp);
+            mState.push_back(state);
+            mKind.push_back(kind);
+        }
+
+        void Remove(size_t i)
+        {
+            auto back = Size() - 1;
+            mX[i] = mX[back]; mVX[i] = mVX[back]; mDX[i] = mDX[back]; mTime[i] = mTime[back]; mCD[i] = mCD[back];
+            mY[i] = mY[back]; mVY[i] = mVY[back]; mDY[i] = mDY[back]; mRadius[i] = mRadius[back];
+            mHp[i] = mHp[back]; mState[i] = mState[back]; mKind[i] = mKind[back];
+            mX.pop_back(); mVX.pop_back(); mDX.pop_back(); mTime.pop_back(); mCD.pop_back();
+            mY.pop_back(); mVY.pop_back(); mDY.pop_back(); mRadius.pop_back();
+            mHp.pop_back(); mState.pop_back(); mKind.pop_back();
+        }
+    };
+
+    Behavior() : mStates(nullptr), mTrans(nullptr), mCount(0)
+    { }
+
+    //  表由调用方持有, 下标已校验
+    void Init(const State * states, uint32_t count, const Trans * trans)
+    {
+        mStates = states;
+        mTrans  = trans;
+        mCount  = count;
+        mStart.assign(count + 1, 0);
+    }
+
+    uint32_t StateCount() const
+    {
+        return mCount;
+    }
+
+    //  新进入state, 计时清零, 开火间隔重新开始
+    void Enter(Agents & agents, size_t i, uint32_t state) const
+    {
+        agents.mState[i] = state;
+        agents.mTime[i]  = 0;
+        agents.mCD[i]    = mStates[state].mFireCD;
+    }
+
+    //  推进dt: 分桶, 逐状态执行行为, 再逐状态判断转移
+    void Update(Agents & agents, const Vec2 & target, float dt, std::vector<Shot> & shots)
+    {
+        Bucket(agents);
+        for (uint32_t s = 0; s != mCount; ++s)
+        {
+            if (mStart[s] != mStart[s + 1]) { Act(s, agents, target, dt, shots); }
+        }
+
+        mNext.assign(agents.mState.begin(), agents.mState.end());
+        for (uint32_t s = 0; s != mCount; ++s)
+        {
+            if (mStart[s] != mStart[s + 1]) { Test(s, agents, target); }
+        }
+        for (size_t i = 0; i != agents.Size(); ++i)
+        {
+            if (mNext[i] != agents.mState[i]) { Enter(agents, i, mNext[i]); }
+        }
+    }
+
+private:
+    //  计数排序, 同一状态的下标连续
+    void Bucket(const Agents & agents)
+    {
+        std::fill(mStart.begin(), mStart.end(), 0);
+        for (auto state : agents.mState) { ++mStart[state + 1]; }
+        for (uint32_t s = 0; s != mCount; ++s) { mStart[s + 1] += mStart[s]; }
+
+        mFill.assign(mStart.begin(), mStart.end() - 1);
+        mOrder.resize(agents.Size());
+        for (uint32_t i = 0; i != (uint32_t)agents.Size(); ++i)
+        {
+            mOrder[mFill[agents.mState[i]]++] = i;
+        }
+    }
+
+    void Act(uint32_t s, Agents & agents, const Vec2 & target, float dt, std::vector<Shot> & shots)
+    {
+        auto & state = mStates[s];
+        auto order = mOrder.data() + mStart[s];
+        auto n     = mStart[s + 1] - mStart[s];
+        auto x  = agents.mX.data(),  y  = agents.mY.data();
+        auto vx = agents.mVX.data(), vy = agents.mVY.data();
+        auto hx = agents.mDX.data(), hy = agents.mDY.data();
+        auto tx = target.x, ty = target.y;
+        auto speed = state.mSpeed;
+
+        //  移动方式按状态分支, 循环内无分支
+        switch (state.mMove)
+        {
+        case Move::kHold:
+            for (uint32_t k = 0; k != n; ++k)
+            {
+                auto i = order[k];
+                vx[i] = 0;
+                vy[i] = 0;
+            }
+            break;
+        case Move::kChase:
+        case Move::kFlee:
+        {
+            auto sign = state.mMove == Move::kChase ? speed : -speed;
+            for (uint32_t k = 0; k != n; ++k)
+            {
+                auto i = order[k];
+                auto dx = tx - x[i], dy = ty - y[i];
+                auto inv = sign / std::sqrt(dx * dx + dy * dy + kEpsilon);
+                vx[i] = dx * inv;
+                vy[i] = dy * inv;
+            }
+            break;
+        }
+        case Move::kOrbit:
+        {
+            //  切向速度加上向半径处的回拉
+            auto radius = state.mParam;
+            for (uint32_t k = 0; k != n; ++k)
+            {
+                auto i = order[k];
+                auto dx = tx - x[i], dy = ty - y[i];
+                auto d  = std::sqrt(dx * dx + dy * dy + kEpsilon);
+                auto nx = dx / d, ny = dy / d;
+                auto pull = std::min(std::max(d - radius, -speed), speed);
+                vx[i] = -ny * speed + nx * pull;
+                vy[i] =  nx * speed + ny * pull;
+            }
+            break;
+        }
+        case Move::kDrift:
+            for (uint32_t k = 0; k != n; ++k)
+            {
+                auto i = order[k];
+                vx[i] = hx[i] * speed;
+                vy[i] = hy[i] * speed;
+            }
+            break;
+        default:
+            break;
+        }
+
+        auto time = agents.mTime.data();
+        for (uint32_t k = 0; k != n; ++k)
+        {
+            auto i = order[k];
+            x[i] += vx[i] * dt;
+            y[i] += vy[i] * dt;
+            time[i] += dt;
+        }
+
+        //  旋转矩阵每状态算一次, 顺带归一化抵消累积误差
+        if (state.mSpin != 0)
+        {
+            auto rot = Math::ToVec(state.mSpin * dt);
+            for (uint32_t k = 0; k != n; ++k)
+            {
+                auto i = order[k];
+                auto dx = hx[i] * rot.x - hy[i] * rot.y;
+                auto dy = hx[i] * rot.y + hy[i] * rot.x;
+                auto inv = 1 / std::sqrt(dx * dx + dy * dy);
+                hx[i] = dx * inv;
+                hy[i] = dy * inv;
+            }
+        }
+        else if (state.mMove != Move::kHold && state.mMove != Move::kDrift)
+        {
+            for (uint32_t k = 0; k != n; ++k)
+            {
+                auto i = order[k];
+                auto inv = 1 / std::sqrt(vx[i] * vx[i] + vy[i] * vy[i] + kEpsilon);
+                hx[i] = vx[i] * inv;
+                hy[i] = vy[i] * inv;
+            }
+        }
+
+        if (state.mFireCD > 0)
+        {
+            auto cd = agents.mCD.data();
+            for (uint32_t k = 0; k != n; ++k)
+            {
+                auto i = order[k];
+                cd[i] -= dt;
+                if (cd[i] > 0) { continue; }
+
+                cd[i] += state.mFireCD;
+                auto coord = Vec2(x[i], y[i]);
+                auto dir   = state.mAim ? Math::Normal(target - coord) : Vec2(hx[i], hy[i]);
+                shots.push_back({ coord, dir });
+            }
+        }
+    }
+
+    void Test(uint32_t s, const Agents & agents, const Vec2 & target)
+    {
+        auto & state = mStates[s];
+        auto order = mOrder.data() + mStart[s];
+        auto n     = mStart[s + 1] - mStart[s];
+        auto next  = mNext.data();
+        auto x = agents.mX.data(), y = agents.mY.data();
+
+        //  逐条转移各扫一遍, 已被前一条选中的跳过
+        for (uint32_t t = state.mFirst; t != state.mFirst + state.mCount; ++t)
+        {
+            auto & trans = mTrans[t];
+            auto value = trans.mValue;
+            auto apply = [&] (auto fn)
+            {
+                for (uint32_t k = 0; k != n; ++k)
+                {
+                    auto i = order[k];
+                    if (next[i] == s && fn(i)) { next[i] = trans.mTo; }
+                }
+            };
+
+            switch (trans.mCond)
+            {
+            case Cond::kAfter:
+            {
+                auto time = agents.mTime.data();
+                apply([=] (uint32_t i) { return time[i] >= value; });
+                break;
+            }
+            case Cond::kNear:
+            case Cond::kFar:
+            {
+                auto sign = trans.mCond == Cond::kNear ? 1.0f : -1.0f;
+                auto edge = sign * value * value;
+                apply([=] (uint32_t i)
+                {
+                    auto dx = target.x - x[i], dy = target.y - y[i];
+                    return sign * (dx * dx + dy * dy) < edge;
+                });
+                break;
+            }
+            case Cond::kHurt:
+            {
+                auto hp = agents.mHp.data();
+                apply([=] (uint32_t i) { return hp[i] < value; });
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+
+    static constexpr float kEpsilon = 1e-6f;
+
+    const State *         mStates;
+    const Trans *         mTrans;
+    uint32_t              mCount;
+    std::vector<uint32_t> mStart;       //  各状态在mOrder中的起点, 多一项作结尾
+    std::vector<uint32_t> mFill;
+    std::vector<uint32_t> mOrder;       //  按状态排序的下标
+    std::vector<uint32_t> mNext;        //  本帧转移的目标状态
+};
@@ -0,0 +1,599 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include "Math.h"
+
+//  碰撞世界: 按层分桶, 排序扫掠宽相 + 圆/扫掠圆窄相, 胶囊与有向盒按8个一批检测
+//  宽相代理表同时作为空间查询的加速结构
+class Collide {
+public:
+    static const size_t kLayerMax = 8;
+    static const size_t kNoProxy  = SIZE_MAX;
+    static const size_t kLanes    = 8;      //  窄相批次宽度
+
+    enum class Shape : uint8_t {
+        kCircle,    //  圆, 半径mRadius
+        kCapsule,   //  胶囊, 沿mAxis半长mHalf.x, 半径mRadius
+        kBox,       //  有向盒, 沿mAxis与其法向半长mHalf, mRadius为圆角
+    };
+
+    //  窄相统一表示: 有向矩形加圆角, 圆退化为点, 胶囊退化为线段
+    struct Rect {
+        float mX, mY;       //  中心
+        float mUX, mUY;     //  朝向单位向量
+        float mHX, mHY;     //  半长宽
+        float mR;           //  圆角
+    };
+
+    struct Body {
+        Vec2     mLast;     //  上次检测位置
+        Vec2     mCoord;    //  当前位置
+        float    mRadius;   //  半径
+        uint32_t mSelf;     //  自身
+        uint32_t mMask;     //  屏蔽
+        bool     mIsFast;   //  连续检测
+        uint32_t mLayer;    //  碰撞层
+        void *   mUser;     //  所属对象
+        size_t   mIndex;    //  在所属层中的下标
+        size_t   mProxy;    //  在所属层代理表中的下标
+        Shape    mShape;    //  形状, 值初始化为圆
+        Vec2     mAxis;     //  朝向单位向量, 圆不使用
+        Vec2     mHalf;     //  胶囊与盒的半长宽
+        Rect     mRect;     //  本帧窄相形状, Update时生成, 高速物体含本帧位移
+    };
+
+    //  查询结果
+    struct Hit {
+        Body * mBody;
+        float  mDist;       //  射线为命中距离, 最近邻为到圆周的距离
+    };
+
+    struct Pair {
+        Body * mA;
+        Body * mB;
+        float  mTime;       //  碰撞时刻[0, 1]
+    };
+
+    struct Proxy {
+        float  mMinX, mMinY;
+        float  mMaxX, mMaxY;
+        Body * mBody;
+
+        bool operator < (const Proxy & v) const
+        {
+            return mMinX < v.mMinX;
+        }
+    };
+
+    Collide()
+    {
+        for (auto & row : mMatrix)
+        {
+            std::fill(std::begin(row), std::end(row), false);
+        }
+    }
+
+    //  层交互矩阵, 对称
+    void SetInteract(uint32_t a, uint32_t b, bool interact)
+    {
+        mMatrix[a][b] = interact;
+        mMatrix[b][a] = interact;
+
+        mLayerPairs.clear();
+        for (uint32_t i = 0; i != kLayerMax; ++i)
+        {
+            for (auto j = i; j != kLayerMax; ++j)
+            {
+                if (mMatrix[i][j]) { mLayerPairs.emplace_back(i, j); }
+            }
+        }
+    }
+
+    bool IsInteract(uint32_t a, uint32_t b) const
+    {
+        return mMatrix[a][b];
+    }
+
+    void Insert(Body * body)
+    {
+        assert(body->mLayer < kLayerMax);
+        auto & layer = mLayers[body->mLayer];
+        body->mIndex = layer.size();
+        body->mProxy = kNoProxy;
+        body->mLast  = body->mCoord;
+        layer.push_back(body);
+    }
+
+    void Remove(Body * body)
+    {
+        if (body->mProxy != kNoProxy)
+        {
+            mProxys[body->mLayer][body->mProxy].mBody = nullptr;
+        }
+
+        auto & layer = mLayers[body->mLayer];
+        auto back = layer.back();
+        back->mIndex = body->mIndex;
+        layer.at(body->mIndex) = back;
+        layer.pop_back();
+    }
+
+    template <class Fn>
+    void ForEach(Fn fn)
+    {
+        for (auto & layer : mLayers)
+        {
+            std::for_each(layer.begin(), layer.end(), fn);
+        }
+    }
+
+    //  空间查询, layers为层位掩码, 结果写入调用方缓冲, 返回写入数量
+    //  使用上次Update的宽相数据, 之后插入的Body到下次Update才可见
+
+    //  与圆相交
+    size_t Overlap(const Cir & cir, uint32_t layers, Body ** out, size_t size) const
+    {
+        size_t count = 0;
+        if (size == 0) { return 0; }
+
+        auto & o = cir.mO;
+        Scan(layers, o.x - cir.mR, o.x + cir.mR, [&] (const Proxy & proxy)
+        {
+            if (proxy.mMinY > o.y + cir.mR || proxy.mMaxY < o.y - cir.mR) { return true; }
+            if (Distance(proxy.mBody, o) <= cir.mR)
+            {
+                out[count++] = proxy.mBody;
+            }
+            return count != size;
+        });
+        return count;
+    }
+
+    //  与矩形[min, max]相交
+    size_t Overlap(const Vec2 & min, const Vec2 & max, uint32_t layers, Body ** out, size_t size) const
+    {
+        size_t count = 0;
+        if (size == 0) { return 0; }
+
+        Scan(layers, min.x, max.x, [&] (const Proxy & proxy)
+        {
+            if (proxy.mMinY > max.y || proxy.mMaxY < min.y) { return true; }
+            auto half = (max - min) * 0.5f;
+            auto rect = Rect{ min.x + half.x, min.y + half.y, 1, 0, half.x, half.y, 0 };
+            if (IsOverlap(rect, ToRect(proxy.mBody)))
+            {
+                out[count++] = proxy.mBody;
+            }
+            return count != size;
+        });
+        return count;
+    }
+
+    //  射线最近命中, dir为单位向量, 起点在圆内时距离为0
+    //  胶囊与盒按外接圆检测
+    bool Raycast(const Vec2 & origin, const Vec2 & dir, float dist, uint32_t layers, Hit & hit) const
+    {
+        hit.mBody = nullptr;
+        hit.mDist = dist;
+        auto end  = origin + dir * dist;
+        auto minY = std::min(origin.y, end.y);
+        auto maxY = std::max(origin.y, end.y);
+        Scan(layers, std::min(origin.x, end.x), std::max(origin.x, end.x), [&] (const Proxy & proxy)
+        {
+            auto t = 0.0f;
+            if (proxy.mMinY <= maxY && proxy.mMaxY >= minY
+                && IsRayHit(origin, dir, proxy.mBody, t) && t <= hit.mDist)
+            {
+                hit.mBody = proxy.mBody;
+                hit.mDist = t;
+            }
+            return true;
+        });
+        return hit.mBody != nullptr;
+    }
+
+    //  线段[a, b]上的全部命中, 按距离升序, 超出size时保留最近的
+    size_t Linecast(const Vec2 & a, const Vec2 & b, uint32_t layers, Hit * out, size_t size) const
+    {
+        size_t count = 0;
+        auto dist = Math::Length(b - a);
+        if (dist == 0 || size == 0) { return 0; }
+
+        auto dir  = (b - a) / dist;
+        auto minY = std::min(a.y, b.y);
+        auto maxY = std::max(a.y, b.y);
+        Scan(layers, std::min(a.x, b.x), std::max(a.x, b.x), [&] (const Proxy & proxy)
+        {
+            auto t = 0.0f;
+            if (proxy.mMinY <= maxY && proxy.mMaxY >= minY
+                && IsRayHit(a, dir, proxy.mBody, t) && t <= dist)
+            {
+                count = Keep(out, count, size, { proxy.mBody, t });
+            }
+            return true;
+        });
+        return count;
+    }
+
+    //  距离coord最近的size个Body, 按到圆周的距离升序
+    size_t Nearest(const Vec2 & coord, uint32_t layers, Hit * out, size_t size) const
+    {
+        size_t count = 0;
+        if (size == 0) { return 0; }
+
+        for (uint32_t i = 0; i != kLayerMax; ++i)
+        {
+            if ((layers & (1u << i)) == 0) { continue; }
+
+            //  从coord.x向两侧扫描, 横向距离超过当前第size近时停止
+            auto & proxys = mProxys[i];
+            auto fn = [] (const Proxy & proxy, float x) { return proxy.mMinX < x; };
+            auto mid = (size_t)(std::lower_bound(proxys.begin(), proxys.end(), coord.x, fn) - proxys.begin());
+            for (auto j = mid; j != proxys.size(); ++j)
+            {
+                if (count == size && proxys[j].mMinX - coord.x > out[count - 1].mDist) { break; }
+                if (proxys[j].mBody != nullptr) { count = Keep(out, count, size, Distance(coord, proxys[j].mBody)); }
+            }
+            for (auto j = mid; j != 0; --j)
+            {
+                if (count == size && coord.x - proxys[j - 1].mMinX - mExtent[i] > out[count - 1].mDist) { break; }
+                if (proxys[j - 1].mBody != nullptr) { count = Keep(out, count, size, Distance(coord, proxys[j - 1].mBody)); }
+            }
+        }
+        return count;
+    }
+
+    //  双方至少一方未屏蔽对方才需要检测
+    static bool IsInterest(const Body * a, const Body * b)
+    {
+        return (a->mSelf & b->mMask) == 0
+            || (b->mSelf & a->mMask) == 0;
+    }
+
+    //  静止形状, 圆的朝向取x轴使退化运算保持有限
+    static Rect ToRect(const Body * body)
+    {
+        auto & c = body->mCoord;
+        switch (body->mShape)
+        {
+        case Shape::kCapsule: return { c.x, c.y, body->mAxis.x, body->mAxis.y, body->mHalf.x, 0, body->mRadius };
+        case Shape::kBox:     return { c.x, c.y, body->mAxis.x, body->mAxis.y, body->mHalf.x, body->mHalf.y, body->mRadius };
+        default:              return { c.x, c.y, 1, 0, 0, 0, body->mRadius };
+        }
+    }
+
+    //  外接圆半径
+    static float Bound(const Body * body)
+    {
+        auto rect = ToRect(body);
+        return std::sqrt(rect.mHX * rect.mHX + rect.mHY * rect.mHY) + rect.mR;
+    }
+
+    //  点到形状表面的距离, 在内部为0
+    static float Distance(const Body * body, const Vec2 & p)
+    {
+        auto rect = ToRect(body);
+        auto dx = p.x - rect.mX, dy = p.y - rect.mY;
+        auto x = std::max(std::abs(dx * rect.mUX + dy * rect.mUY) - rect.mHX, 0.0f);
+        auto y = std::max(std::abs(dy * rect.mUX - dx * rect.mUY) - rect.mHY, 0.0f);
+        return std::max(std::sqrt(x * x + y * y) - rect.mR, 0.0f);
+    }
+
+    //  两个圆角矩形相交: 矩形本身相交(4轴分离), 或最近距离不超过圆角之和
+    //  不相交的凸多边形最近点必有一个是顶点, 取双方各4个顶点到对方矩形的距离
+    //  无分支, 批次内逐道展开后由编译器向量化
+    static bool IsOverlap(const Rect & a, const Rect & b)
+    {
+        auto dx = b.mX - a.mX, dy = b.mY - a.mY;
+
+        //  b的朝向在a坐标系下为(c, s)
+        auto c  = a.mUX * b.mUX + a.mUY * b.mUY;
+        auto s  = a.mUX * b.mUY - a.mUY * b.mUX;
+        auto ac = std::abs(c), as = std::abs(s);
+
+        //  中心差在双方坐标系下的分量
+        auto ax = dx * a.mUX + dy * a.mUY, ay = dy * a.mUX - dx * a.mUY;
+        auto bx = dx * b.mUX + dy * b.mUY, by = dy * b.mUX - dx * b.mUY;
+
+        auto cross = (std::abs(ax) <= a.mHX + b.mHX * ac + b.mHY * as)
+                   & (std::abs(ay) <= a.mHY + b.mHX * as + b.mHY * ac)
+                   & (std::abs(bx) <= b.mHX + a.mHX * ac + a.mHY * as)
+                   & (std::abs(by) <= b.mHY + a.mHX * as + a.mHY * ac);
+
+        //  点(x, y)到半长宽(hx, hy)矩形的距离平方
+        auto gap = [] (float x, float y, float hx, float hy)
+        {
+            auto gx = std::max(std::abs(x) - hx, 0.0f);
+            auto gy = std::max(std::abs(y) - hy, 0.0f);
+            return gx * gx + gy * gy;
+        };
+
+        //  a的顶点在b坐标系下: -(bx, by) ± a.mHX * (c, -s) ± a.mHY * (s, c)
+        auto ex = a.mHX * c, ey = -a.mHX * s;
+        auto fx = a.mHY * s, fy =  a.mHY * c;
+        auto d = std::min(std::min(gap(-bx + ex + fx, -by + ey + fy, b.mHX, b.mHY),
+                                   gap(-bx + ex - fx, -by + ey - fy, b.mHX, b.mHY)),
+                          std::min(gap(-bx - ex + fx, -by - ey + fy, b.mHX, b.mHY),
+                                   gap(-bx - ex - fx, -by - ey - fy, b.mHX, b.mHY)));
+
+        //  b的顶点在a坐标系下: (ax, ay) ± b.mHX * (c, s) ± b.mHY * (-s, c)
+        auto gx = b.mHX * c, gy = b.mHX * s;
+        auto hx = -b.mHY * s, hy = b.mHY * c;
+        d = std::min(d, std::min(std::min(gap(ax + gx + hx, ay + gy + hy, a.mHX, a.mHY),
+                                          gap(ax + gx - hx, ay + gy - hy, a.mHX, a.mHY)),
+                                 std::min(gap(ax - gx + hx, ay - gy + hy, a.mHX, a.mHY),
+                                          gap(ax - gx - hx, ay - gy - hy, a.mHX, a.mHY))));
+
+        auto r = a.mR + b.mR;
+        return cross | (d <= r * r);
+    }
+
+    //  批次: 一个形状对kLanes个候选, 按分量存放
+    struct Lanes {
+        float mX[kLanes], mY[kLanes];
+        float mUX[kLanes], mUY[kLanes];
+        float mHX[kLanes], mHY[kLanes];
+        float mR[kLanes];
+        Body * mBody[kLanes];
+        size_t mCount;
+
+        void Push(Body * body)
+        {
+            auto & rect = body->mRect;
+            auto i = mCount++;
+            mX[i]  = rect.mX;  mY[i]  = rect.mY;
+            mUX[i] = rect.mUX; mUY[i] = rect.mUY;
+            mHX[i] = rect.mHX; mHY[i] = rect.mHY;
+            mR[i]  = rect.mR;
+            mBody[i] = body;
+        }
+    };
+
+    //  a与批次各道的相交结果, 第i位对应第i道, 只取前mCount道
+    static uint32_t Overlap(const Rect & a, const Lanes & lanes)
+    {
+        uint32_t hit[kLanes];   //  与float同宽, 一道占一个分量
+        for (size_t i = 0; i != kLanes; ++i)
+        {
+            hit[i] = IsOverlap(a, Rect{ lanes.mX[i], lanes.mY[i], lanes.mUX[i], lanes.mUY[i],
+                                        lanes.mHX[i], lanes.mHY[i], lanes.mR[i] });
+        }
+
+        uint32_t mask = 0;
+        for (size_t i = 0; i != kLanes; ++i)
+        {
+            mask |= hit[i] << i;
+        }
+        return mask & ((1u << lanes.mCount) - 1);
+    }
+
+    static bool IsOverlap(const Body * a, const Body * b, float & time)
+    {
+        if (a->mIsFast || b->mIsFast)
+        {
+            //  非高速物体视为静止于当前位置
+            auto & la = a->mIsFast ? a->mLast : a->mCoord;
+            auto & lb = b->mIsFast ? b->mLast : b->mCoord;
+            return Math::IsSweepContains(Cir(la, a->mRadius), a->mCoord - la,
+                                         Cir(lb, b->mRadius), b->mCoord - lb, time);
+        }
+        time = 1.0f;
+        return Math::IsContains(Cir(a->mCoord, a->mRadius),
+                                Cir(b->mCoord, b->mRadius));
+    }
+
+    //  生成本帧碰撞对, 调用前需同步所有Body的mCoord
+    const std::vector<Pair> & Update()
+    {
+        mPairs.clear();
+        mTested = 0;
+        for (uint32_t i = 0; i != kLayerMax; ++i)
+        {
+            auto & proxys = mProxys[i];
+            proxys.clear();
+            for (auto body : mLayers[i])
+            {
+                Proxy proxy;
+                auto & rect = body->mRect = SweepRect(body);
+                auto ux = std::abs(rect.mUX), uy = std::abs(rect.mUY);
+                auto ex = ux * rect.mHX + uy * rect.mHY + rect.mR;
+                auto ey = uy * rect.mHX + ux * rect.mHY + rect.mR;
+                proxy.mMinX = rect.mX - ex;
+                proxy.mMinY = rect.mY - ey;
+                proxy.mMaxX = rect.mX + ex;
+                proxy.mMaxY = rect.mY + ey;
+                proxy.mBody = body;
+                proxys.push_back(proxy);
+            }
+            std::sort(proxys.begin(), proxys.end());
+
+            mExtent[i] = 0;
+            for (size_t j = 0; j != proxys.size(); ++j)
+            {
+                proxys[j].mBody->mProxy = j;
+                mExtent[i] = std::max(mExtent[i], proxys[j].mMaxX - proxys[j].mMinX);
+            }
+        }
+
+        //  只遍历有交互的层对
+        for (auto & pair : mLayerPairs)
+        {
+            if (pair.first == pair.second)
+            {
+                Sweep(mProxys[pair.first]);
+            }
+            else
+            {
+                Sweep(mProxys[pair.first], mProxys[pair.second]);
+            }
+        }
+
+        ForEach([] (Body * body) { body->mLast = body->mCoord; });
+        return mPairs;
+    }
+
+    std::vector<Body *> mLayers[kLayerMax];
+    std::vector<Proxy>  mProxys[kLayerMax];
+    std::vector<Pair>   mPairs;
+    size_t mTested = 0;     //  上次Update进入窄相的对数
+
+private:
+    //  遍历各层中x区间与[minX, maxX]相交的代理, fn返回false时终止
+    template <class Fn>
+    void Scan(uint32_t layers, float minX, float maxX, Fn fn) const
+    {
+        for (uint32_t i = 0; i != kLayerMax; ++i)
+        {
+            if ((layers & (1u << i)) == 0) { continue; }
+
+            //  代理按mMinX有序, 宽度不超过mExtent
+            auto & proxys = mProxys[i];
+            auto cmp = [] (const Proxy & proxy, float x) { return proxy.mMinX < x; };
+            auto it  = std::lower_bound(proxys.begin(), proxys.end(), minX - mExtent[i], cmp);
+            for (; it != proxys.end() && it->mMinX <= maxX; ++it)
+            {
+                if (it->mBody != nullptr && it->mMaxX >= minX && !fn(*it)) { return; }
+            }
+        }
+    }
+
+    //  高速物体的形状扩展到覆盖本帧位移: 中心取两端中点, 位移分解到朝向与法向加到半长宽上
+    //  沿朝向运动的胶囊(子弹)是精确的, 其余方向偏保守; 高速的圆扩展为胶囊
+    static Rect SweepRect(const Body * body)
+    {
+        auto rect = ToRect(body);
+        if (!body->mIsFast) { return rect; }
+
+        auto d = body->mCoord - body->mLast;
+        rect.mX -= d.x * 0.5f;
+        rect.mY -= d.y * 0.5f;
+        if (body->mShape == Shape::kCircle)
+        {
+            auto len = Math::Length(d);
+            if (len != 0) { rect.mUX = d.x / len; rect.mUY = d.y / len; }
+            rect.mHX = len * 0.5f;
+        }
+        else
+        {
+            rect.mHX += std::abs(d.x * rect.mUX + d.y * rect.mUY) * 0.5f;
+            rect.mHY += std::abs(d.y * rect.mUX - d.x * rect.mUY) * 0.5f;
+        }
+        return rect;
+    }
+
+    static bool IsRayHit(const Vec2 & origin, const Vec2 & dir, const Body * body, float & t)
+    {
+        auto r = body->mShape == Shape::kCircle ? body->mRadius : Bound(body);
+        auto m = origin - body->mCoord;
+        auto b = Math::Dot(m, dir);
+        auto c = Math::LengthSqr(m) - r * r;
+        if (c > 0 && b > 0) { return false; }
+
+        auto disc = b * b - c;
+        if (disc < 0) { return false; }
+
+        t = std::max(0.0f, -b - std::sqrt(disc));
+        return true;
+    }
+
+    static Hit Distance(const Vec2 & coord, Body * body)
+    {
+        return { body, Distance(body, coord) };
+    }
+
+    //  插入有序结果表, 表满时丢弃最远的
+    static size_t Keep(Hit * out, size_t count, size_t size, const Hit & hit)
+    {
+        if (count == size && hit.mDist >= out[count - 1].mDist) { return count; }
+
+        auto i = count == size ? count - 1 : count;
+        for (; i != 0 && out[i - 1].mDist > hit.mDist; --i)
+        {
+            out[i] = out[i - 1];
+        }
+        out[i] = hit;
+        return std::min(count + 1, size);
+    }
+
+    void Test(const Proxy & a, const Proxy & b)
+    {
+        if (b.mMinY > a.mMaxY || b.mMaxY < a.mMinY) { return; }
+        if (!IsInterest(a.mBody, b.mBody))          { return; }
+
+        ++mTested;
+        if (a.mBody->mShape == Shape::kCircle && b.mBody->mShape == Shape::kCircle)
+        {
+            auto time = 0.0f;
+            if (IsOverlap(a.mBody, b.mBody, time))
+            {
+                mPairs.push_back({ a.mBody, b.mBody, time });
+            }
+            return;
+        }
+
+        //  含胶囊或盒的对攒批, 同一内层扫描的a相同
+        mLanes.Push(b.mBody);
+        if (mLanes.mCount == kLanes) { Flush(a.mBody); }
+    }
+
+    //  批次检测, 命中时刻取帧末
+    void Flush(Body * a)
+    {
+        if (mLanes.mCount == 0) { return; }
+
+        auto mask = Overlap(a->mRect, mLanes);
+        for (size_t i = 0; i != mLanes.mCount; ++i)
+        {
+            if ((mask & (1u << i)) != 0) { mPairs.push_back({ a, mLanes.mBody[i], 1.0f }); }
+        }
+        mLanes.mCount = 0;
+    }
+
+    //  同层
+    void Sweep(const std::vector<Proxy> & ls)
+    {
+        for (size_t i = 0; i != ls.size(); ++i)
+        {
+            for (auto j = i + 1; j != ls.size() && ls[j].mMinX <= ls[i].mMaxX; ++j)
+            {
+                Test(ls[i], ls[j]);
+            }
+            Flush(ls[i].mBody);
+        }
+    }
+
+    //  异层, 两个有序表归并扫描
+    void Sweep(const std::vector<Proxy> & la, const std::vector<Proxy> & lb)
+    {
+        size_t ia = 0, ib = 0;
+        while (ia != la.size() && ib != lb.size())
+        {
+            if (la[ia].mMinX <= lb[ib].mMinX)
+            {
+                for (auto j = ib; j != lb.size() && lb[j].mMinX <= la[ia].mMaxX; ++j)
+                {
+                    Test(la[ia], lb[j]);
+                }
+                Flush(la[ia].mBody);
+                ++ia;
+            }
+            else
+            {
+                for (auto j = ia; j != la.size() && la[j].mMinX <= lb[ib].mMaxX; ++j)
+                {
+                    Test(lb[ib], la[j]);
+                }
+                Flush(lb[ib].mBody);
+                ++ib;
+            }
+        }
+    }
+
+    float mExtent[kLayerMax] = { };     //  各层代理最大宽度
+    Lanes mLanes = { };                 //  窄相批次
+    bool mMatrix[kLayerMax][kLayerMax];
+    std::vector<std::pair<uint32_t, uint32_t>> mLayerPairs;
+};
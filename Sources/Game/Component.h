@@ -4,67 +4,231 @@
 #include <iostream>
 
 namespace Game {
+    //  变换, 有父节点时mLocal相对父节点, 读取的都是世界变换
+    //  写入时标记子树为脏, 读取时沿父链按需重算; UpdateTransform每帧按深度顺序统一重算
     struct CompTransform : Component {
     private:
-        Vec2 mCoord;
-        float mScale = 1;
-        float mAngle = 0;
+        struct Pose {
+            Vec2  mCoord;
+            float mScale = 1;
+            float mAngle = 0;       //  角度制
+        };
+        Pose mLocal;
+        Pose mWorld;
+        CompTransform * mParent = nullptr;
+        CompTransform * mChild  = nullptr;  //  首个子节点
+        CompTransform * mNext   = nullptr;  //  下一个兄弟
+        uint   mDepth = 0;
+        size_t mIndex = kNoIndex;           //  在mHierarchy中的下标
+        bool   mIsDirty = false;            //  脏节点的子树必然全脏
+
+        static Pose Compose(const Pose & parent, const Pose & local)
+        {
+            auto r = parent.mAngle * (3.14159265f / 180);
+            auto c = std::cos(r), s = std::sin(r);
+            auto x = local.mCoord.x * parent.mScale;
+            auto y = local.mCoord.y * parent.mScale;
+            Pose pose;
+            pose.mCoord = parent.mCoord + Vec2(x * c - y * s, x * s + y * c);
+            pose.mScale = parent.mScale * local.mScale;
+            pose.mAngle = parent.mAngle + local.mAngle;
+            return pose;
+        }
+
+        //  根节点世界即本地, 立即生效
+        void Touch()
+        {
+            if (mParent == nullptr) { mWorld = mLocal; } else { mIsDirty = false; MarkDirty(); }
+            for (auto child = mChild; child != nullptr; child = child->mNext) { child->MarkDirty(); }
+        }
+
+        void MarkDirty()
+        {
+            if (mIsDirty) { return; }
+            mIsDirty = true;
+            Ctx()->mPlay.mHierarchyDirty.at(mIndex) = 1;
+            for (auto child = mChild; child != nullptr; child = child->mNext) { child->MarkDirty(); }
+        }
+
+        void SetDepth(uint depth)
+        {
+            mDepth = depth;
+            for (auto child = mChild; child != nullptr; child = child->mNext) { child->SetDepth(depth + 1); }
+        }
+
+        //  脱离父节点, 保持世界变换
+        void Detach()
+        {
+            auto world = World();
+            auto link  = &mParent->mChild;
+            while (*link != this) { link = &(*link)->mNext; }
+            *link = mNext;
+            mParent = nullptr;
+            mNext   = nullptr;
+            mLocal  = world;
+            mWorld  = world;
+            mIsDirty = false;
+            SetDepth(0);
+
+            auto & play = Ctx()->mPlay;
+            play.mHierarchy.at(mIndex) = nullptr;
+            play.mHierarchyDirty.at(mIndex) = 0;
+            play.mIsHierarchyDirty = true;
+            mIndex = kNoIndex;
+        }
+
+        const Pose & World()
+        {
+            if (mIsDirty) { Resolve(); }
+            return mWorld;
+        }
 
     public:
-        void Coord(const Vec2 & coord) { mCoord = coord; }
-        void Scale(float scale) { mScale = scale; }
-        void Angle(float angle) { mAngle = angle; }
-        const Vec2 & Coord() { return mCoord; }
-        float Scale() { return mScale; }
-        float Angle() { return mAngle; }
+        void Coord(const Vec2 & coord) { mLocal.mCoord = coord; Touch(); }
+        void Scale(float scale) { mLocal.mScale = scale; Touch(); }
+        void Angle(float angle) { mLocal.mAngle = angle; Touch(); }
+        const Vec2 & Coord() { return World().mCoord; }
+        float Scale() { return World().mScale; }
+        float Angle() { return World().mAngle; }
+
+        //  本地变换, 根节点与世界变换相同
+        const Vec2 & LocalCoord() { return mLocal.mCoord; }
+        float LocalScale() { return mLocal.mScale; }
+        float LocalAngle() { return mLocal.mAngle; }
+
+        CompTransform * Parent() { return mParent; }
+
+        //  挂到parent下, 当前本地变换视为相对parent, nullptr为脱离
+        void Parent(CompTransform * parent)
+        {
+            if (mParent == parent) { return; }
+            if (mParent != nullptr) { Detach(); }
+            if (parent == nullptr) { return; }
+
+            mParent = parent;
+            mNext   = parent->mChild;
+            parent->mChild = this;
+            SetDepth(parent->mDepth + 1);
+
+            auto & play = Ctx()->mPlay;
+            mIndex = play.mHierarchy.size();
+            play.mHierarchy.push_back(this);
+            play.mHierarchyDirty.push_back(0);
+            play.mIsHierarchyDirty = true;
+            mIsDirty = false;
+            MarkDirty();
+        }
+
+        //  父节点必须已是最新, UpdateTransform按深度顺序调用
+        void Resolve()
+        {
+            if (mParent->mIsDirty) { mParent->Resolve(); }
+            mWorld = Compose(mParent->mWorld, mLocal);
+            mIsDirty = false;
+            Ctx()->mPlay.mHierarchyDirty[mIndex] = 0;
+        }
+
+        uint Depth() const { return mDepth; }
+        bool IsDirty() const { return mIsDirty; }
+        void Index(size_t index) { mIndex = index; }
 
         virtual void OnUpdate(float dt) override { }
         virtual void OnEnter() override { }
-        virtual void OnLeave() override { }
-        virtual const type_info & GetType() override
+
+        //  子节点随父节点删除
+        virtual void OnLeave() override
+        {
+            while (mChild != nullptr)
+            {
+                auto child = mChild;
+                child->Detach();
+                DeleteActor(child->mOwner);
+            }
+            if (mParent != nullptr) { Detach(); }
+        }
+
+        virtual bool IsTick() override { return false; }
+
+        //  层级不随预制体复制
+        virtual Component * Clone() override
+        {
+            auto clone = new CompTransform(*this);
+            clone->mParent = clone->mChild = clone->mNext = nullptr;
+            clone->mDepth = 0;
+            clone->mIndex = kNoIndex;
+            clone->mIsDirty = false;
+            clone->mWorld = clone->mLocal;
+            return clone;
+        }
+
+        virtual const std::type_info & GetType() override
         {
             return typeid(CompTransform);
         }
     };
 
     struct CompSprite : Component {
-    private:
-        std::vector<Simple2D::Image *> mFrames;
-
     public:
-        uint mCurr;
-        Vec2 mAnchor;
-        bool mIsLoop;
-        float mInterval;
-        float mLoopTime;
+        const Clip * mClip;
+        float  mStart;      //  开始时间
+        uint   mCurr;       //  当前帧, 由UpdateAnimate批量写入
+        size_t mIndex;      //  在mAnimates中的下标
 
-        void AddFrame(Simple2D::Image * image)
+        //  进入场景前设置
+        void SetClip(const Clip * clip)
         {
-            mFrames.push_back(image);
+            mClip  = clip;
+            mCurr  = 0;
+            mStart = Ctx()->mLastTime;
+            mOwner->mBound = std::max(mOwner->mBound, clip->mBound);
         }
 
         virtual void OnUpdate(float dt)
         {
-            mLoopTime += dt;
-            mCurr = (uint)(mLoopTime / mInterval);
-            mCurr = mIsLoop ? (uint)(mCurr  % mFrames.size())
-                            : std::min(mCurr, mFrames.size() - 1);
+            if (!mOwner->mIsVisible)
+            {
+                return;
+            }
 
-            auto w = 0, h = 0;
-            auto frame = mFrames.at(mCurr);
-            Simple2D::GetImageSize(frame, &w, &h);
-            Simple2D::DrawImage(frame,
-                                mOwner->mTrans->Coord().x - w * mAnchor.x,
-                                mOwner->mTrans->Coord().y - h * mAnchor.y,
+            auto & frame = mClip->mFrames[mCurr];
+            Ctx()->mDraw->Image(frame.mImage,
+                                mOwner->mTrans->Coord().x - frame.mOffset.x,
+                                mOwner->mTrans->Coord().y - frame.mOffset.y,
                                 mOwner->mTrans->Angle(), mOwner->mTrans->Scale());
         }
 
-        virtual void OnEnter() override { }
-        virtual void OnLeave() override { }
-        virtual const type_info & GetType() override
+        //  单帧精灵不参与动画
+        virtual void OnEnter() override
+        {
+            mStart = Ctx()->mLastTime;
+            if (mClip->mFrames.size() > 1)
+            {
+                auto & animates = Ctx()->mPlay.mAnimates;
+                mIndex = animates.size();
+                animates.push_back(this);
+            }
+        }
+
+        virtual void OnLeave() override
+        {
+            if (mClip->mFrames.size() > 1)
+            {
+                auto & animates = Ctx()->mPlay.mAnimates;
+                animates.back()->mIndex = mIndex;
+                animates.at(mIndex) = animates.back();
+                animates.pop_back();
+            }
+        }
+
+        virtual const std::type_info & GetType() override
         {
             return typeid(CompSprite);
         }
+
+        virtual Component * Clone() override
+        {
+            return new CompSprite(*this);
+        }
     };
 
     struct CompText : Component {
@@ -85,19 +249,84 @@ namespace Game {
 
         virtual void OnUpdate(float dt) override
         {
-            Simple2D::DrawString(mFont, mText,
-                                 mOwner->mTrans->Coord().x,
-                                 mOwner->mTrans->Coord().y,
-                                 mOwner->mTrans->Angle(),
-                                 mOwner->mTrans->Scale());
+            Ctx()->mDraw->Text(mFont, mText,
+                               mOwner->mTrans->Coord().x,
+                               mOwner->mTrans->Coord().y,
+                               mOwner->mTrans->Angle(),
+                               mOwner->mTrans->Scale());
         }
 
         virtual void OnEnter() override { }
         virtual void OnLeave() override { }
-        virtual const type_info & GetType() override
+        virtual const std::type_info & GetType() override
         {
             return typeid(CompText);
         }
+
+        virtual Component * Clone() override
+        {
+            return new CompText(*this);
+        }
+    };
+
+    //  碰撞
+    struct CompCollision : Component {
+    public:
+        uint mSelf; //  自身
+        uint mMask; //  屏蔽
+        float mRadius;
+        bool mIsFast;   //  高速物体, 使用连续检测
+        CollisionLayer mLayer;
+        Collide::Shape mShape;  //  默认圆, 胶囊与盒随Actor旋转
+        Vec2 mHalf;             //  胶囊与盒的半长宽, 沿Actor朝向与其法向
+        std::function<void(CompCollision *)> mHitFn;
+        Collide::Body mBody;
+
+        void OnHit(CompCollision * other)
+        {
+            if (mHitFn != nullptr && (other->mSelf & mMask) == 0)
+            {
+                mHitFn(other);
+            }
+        }
+
+        virtual void OnEnter() override
+        {
+            mBody.mCoord  = mOwner->mTrans->Coord();
+            mBody.mRadius = mRadius;
+            mBody.mSelf   = mSelf;
+            mBody.mMask   = mMask;
+            mBody.mIsFast = mIsFast;
+            mBody.mLayer  = (uint)mLayer;
+            mBody.mShape  = mShape;
+            mBody.mHalf   = mHalf;
+            mBody.mAxis   = Math::ToVec(mOwner->mTrans->Angle());
+            mBody.mUser   = this;
+            Ctx()->mPlay.mCollide.Insert(&mBody);
+        }
+
+        virtual void OnLeave() override
+        {
+            Ctx()->mPlay.mCollide.Remove(&mBody);
+        }
+
+        virtual void OnUpdate(float dt) override
+        { }
+
+        virtual bool IsTick() override
+        {
+            return false;
+        }
+
+        virtual const std::type_info & GetType() override
+        {
+            return typeid(CompCollision);
+        }
+
+        virtual Component * Clone() override
+        {
+            return new CompCollision(*this);
+        }
     };
 
     //  滚屏
@@ -155,7 +384,7 @@ namespace Game {
             auto v = coord.y / (mScreenSize.y * 0.5f); v -= std::floor(std::abs(u)) * mSign;
             auto fx = Math::Lerp(-mOriginSize.x, mOriginSize.x, u + mBase); fx *= mZero.x;
             auto fy = Math::Lerp(-mOriginSize.y, mOriginSize.y, v + mBase); fy *= mZero.y;
-            Simple2D::DrawImage(mImage,
+            Ctx()->mDraw->Image(mImage,
                 mOwner->mTrans->Coord().x + fx,
                 mOwner->mTrans->Coord().y + fy,
                 mOwner->mTrans->Angle(),
@@ -164,7 +393,7 @@ namespace Game {
 
         virtual void OnEnter() override { }
         virtual void OnLeave() override { }
-        virtual const type_info & GetType() override
+        virtual const std::type_info & GetType() override
         {
             return typeid(CompScrollScreen);
         }
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <typeinfo>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include "Memory.h"
+
+//  类型化事件总线, 每种事件一个连续缓冲, Dispatch时按类型批量派发
+//  缓冲复用容量, 稳定后发布事件不分配内存
+class EventBus {
+public:
+    template <typename T>
+    using Handler = std::function<void(const T * events, size_t count)>;
+
+    //  事件流量统计
+    struct Stat {
+        const char * mName;
+        uint64_t mCount;    //  派发的事件数
+        uint64_t mBatch;    //  派发批次
+        float    mTime;     //  派发耗时(ms)
+    };
+
+    EventBus() : mNextID(0)
+    { }
+
+    template <typename T>
+    uint32_t Subscribe(Handler<T> fn)
+    {
+        auto & channel = Get<T>();
+        auto & handlers = channel.mIsDispatch ? channel.mAdded : channel.mHandlers;
+        handlers.push_back({ ++mNextID, std::move(fn) });
+        return mNextID;
+    }
+
+    template <typename T>
+    void Unsubscribe(uint32_t id)
+    {
+        auto & channel = Get<T>();
+        for (auto & handler : channel.mHandlers)
+        {
+            if (handler.mID == id) { handler.mID = 0; channel.mIsDirty = true; }
+        }
+        for (auto & handler : channel.mAdded)
+        {
+            if (handler.mID == id) { handler.mID = 0; channel.mIsDirty = true; }
+        }
+    }
+
+    template <typename T>
+    void Publish(const T & event)
+    {
+        Get<T>().mQueue.push_back(event);
+    }
+
+    //  派发已排队的事件, 派发过程中发布的事件留到下一次
+    void Dispatch()
+    {
+        for (auto & channel : mChannels)
+        {
+            if (channel != nullptr) { channel->Dispatch(); }
+        }
+    }
+
+    std::vector<Stat> Stats() const
+    {
+        std::vector<Stat> stats;
+        for (auto & channel : mChannels)
+        {
+            if (channel != nullptr) { stats.push_back(channel->mStat); }
+        }
+        return stats;
+    }
+
+private:
+    struct Channel {
+        Stat mStat;
+        virtual ~Channel() {}
+        virtual void Dispatch() = 0;
+    };
+
+    template <typename T>
+    struct TypedChannel : Channel {
+        struct Entry {
+            uint32_t   mID;     //  0为已退订
+            Handler<T> mFn;
+        };
+        std::vector<T, Memory::Allocator<T, Memory::Tag::kEvent>> mQueue;
+        std::vector<T, Memory::Allocator<T, Memory::Tag::kEvent>> mBatch;
+        std::vector<Entry> mHandlers;
+        std::vector<Entry> mAdded;      //  派发中订阅
+        bool mIsDispatch = false;
+        bool mIsDirty    = false;
+
+        virtual void Dispatch() override
+        {
+            if (mQueue.empty()) { return; }
+
+            auto start = std::chrono::steady_clock::now();
+            std::swap(mQueue, mBatch);
+            mIsDispatch = true;
+            for (auto & handler : mHandlers)
+            {
+                if (handler.mID != 0) { handler.mFn(mBatch.data(), mBatch.size()); }
+            }
+            mIsDispatch = false;
+
+            mStat.mCount += mBatch.size();
+            mStat.mBatch += 1;
+            mStat.mTime  += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+            mBatch.clear();
+
+            for (auto & handler : mAdded) { mHandlers.push_back(std::move(handler)); }
+            mAdded.clear();
+            if (mIsDirty)
+            {
+                auto fn = [] (const Entry & handler) { return handler.mID == 0; };
+                mHandlers.erase(std::remove_if(mHandlers.begin(), mHandlers.end(), fn), mHandlers.end());
+                mIsDirty = false;
+            }
+        }
+    };
+
+    static uint32_t NextType()
+    {
+        static std::atomic<uint32_t> sNext(0);
+        return sNext++;
+    }
+
+    template <typename T>
+    static uint32_t TypeID()
+    {
+        static const uint32_t sID = NextType();
+        return sID;
+    }
+
+    template <typename T>
+    TypedChannel<T> & Get()
+    {
+        auto id = TypeID<T>();
+        if (id >= mChannels.size()) { mChannels.resize(id + 1); }
+
+        auto & channel = mChannels[id];
+        if (channel == nullptr)
+        {
+            channel.reset(new TypedChannel<T>());
+            channel->mStat = { typeid(T).name(), 0, 0, 0 };
+        }
+        return static_cast<TypedChannel<T> &>(*channel);
+    }
+
+    std::vector<std::unique_ptr<Channel>> mChannels;
+    uint32_t mNextID;
+};
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "Math.h"
+
+//  流场寻路: 网格上从目标出发的距离场, 每格存下降方向, 代理O(1)采样
+//  目标换格或阻挡变化时才重算, 缓冲Init后不再分配
+class Flow {
+public:
+    static const uint32_t kNoCell = UINT32_MAX;
+
+    //  代理, SoA布局
+    struct Agents {
+        std::vector<float>    mX,  mY;      //  位置
+        std::vector<float>    mVX, mVY;     //  速度
+        std::vector<float>    mTX, mTY;     //  本帧期望速度
+        std::vector<uint32_t> mCell;        //  所在格
+
+        size_t Size() const { return mX.size(); }
+
+        void Append(const Vec2 & coord)
+        {
+            mX.push_back(coord.x);  mY.push_back(coord.y);
+            mVX.push_back(0);       mVY.push_back(0);
+            mTX.push_back(0);       mTY.push_back(0);
+            mCell.push_back(0);
+        }
+
+        void Remove(size_t i)
+        {
+            auto back = Size() - 1;
+            mX[i] = mX[back]; mVX[i] = mVX[back]; mTX[i] = mTX[back];
+            mY[i] = mY[back]; mVY[i] = mVY[back]; mTY[i] = mTY[back];
+            mCell[i] = mCell[back];
+            mX.pop_back(); mVX.pop_back(); mTX.pop_back();
+            mY.pop_back(); mVY.pop_back(); mTY.pop_back();
+            mCell.pop_back();
+        }
+    };
+
+    void Init(const Vec2 & range, float cell)
+    {
+        mRange = range;
+        mCell  = cell;
+        mInv   = 1.0f / cell;
+        mCols  = std::max(1u, (uint32_t)std::ceil(range.x * mInv));
+        mRows  = std::max(1u, (uint32_t)std::ceil(range.y * mInv));
+
+        auto n = (size_t)mCols * mRows;
+        mBlock.assign(n, 0);
+        mDist.assign(n, kFar);
+        mDirX.assign(n, 0);
+        mDirY.assign(n, 0);
+        mSepX.assign(n, 0);
+        mSepY.assign(n, 0);
+        mCount.assign(n, 0);
+        mStart.assign(n + 1, 0);
+        mHeap.clear();
+        mHeap.reserve(n * 8 + 1);
+        mGoal = kNoCell;
+        mIsDirty = true;
+    }
+
+    uint32_t Cell(float x, float y) const
+    {
+        auto cx = (uint32_t)std::min(std::max(x * mInv, 0.0f), (float)(mCols - 1));
+        auto cy = (uint32_t)std::min(std::max(y * mInv, 0.0f), (float)(mRows - 1));
+        return cy * mCols + cx;
+    }
+
+    void SetBlock(const Vec2 & coord, bool isBlock)
+    {
+        auto & block = mBlock[Cell(coord.x, coord.y)];
+        if (block != (uint8_t)isBlock)
+        {
+            block = isBlock;
+            mIsDirty = true;
+        }
+    }
+
+    //  返回是否重算了流场
+    bool Update(const Vec2 & goal)
+    {
+        auto cell = Cell(goal.x, goal.y);
+        if (cell == mGoal && !mIsDirty) { return false; }
+
+        mGoal = cell;
+        mIsDirty = false;
+        Integrate();
+        Gradient();
+        return true;
+    }
+
+    Vec2 Sample(const Vec2 & coord) const
+    {
+        auto cell = Cell(coord.x, coord.y);
+        return Vec2(mDirX[cell], mDirY[cell]);
+    }
+
+    //  转向: 期望速度 = 流场方向 * speed + 格密度梯度 * separate
+    //  accel为速度趋近期望速度的速率, 位置限制在场地内
+    void Steer(Agents & agents, float speed, float separate, float accel, float dt)
+    {
+        auto n  = agents.Size();
+        auto x  = agents.mX.data(),  y  = agents.mY.data();
+        auto vx = agents.mVX.data(), vy = agents.mVY.data();
+        auto tx = agents.mTX.data(), ty = agents.mTY.data();
+        auto cell = agents.mCell.data();
+
+        for (size_t i = 0; i != n; ++i) { cell[i] = Cell(x[i], y[i]); }
+        Bucket(agents);
+        Separate(separate);
+
+        //  按格采样
+        for (size_t i = 0; i != n; ++i) { tx[i] = mDirX[cell[i]] * speed + mSepX[cell[i]]; }
+        for (size_t i = 0; i != n; ++i) { ty[i] = mDirY[cell[i]] * speed + mSepY[cell[i]]; }
+
+        //  无分支循环, 交给编译器向量化
+        auto k = std::min(1.0f, accel * dt);
+        auto maxX = mRange.x, maxY = mRange.y;
+        for (size_t i = 0; i != n; ++i) { vx[i] += (tx[i] - vx[i]) * k; }
+        for (size_t i = 0; i != n; ++i) { vy[i] += (ty[i] - vy[i]) * k; }
+        for (size_t i = 0; i != n; ++i) { x[i] = std::min(std::max(x[i] + vx[i] * dt, 0.0f), maxX); }
+        for (size_t i = 0; i != n; ++i) { y[i] = std::min(std::max(y[i] + vy[i] * dt, 0.0f), maxY); }
+    }
+
+    //  遍历上次Steer时位于圆覆盖格内的代理下标, fn返回false时终止
+    template <class Fn>
+    void ForEach(const Cir & cir, Fn fn) const
+    {
+        auto min = Cell(cir.mO.x - cir.mR, cir.mO.y - cir.mR);
+        auto max = Cell(cir.mO.x + cir.mR, cir.mO.y + cir.mR);
+        for (auto row = min / mCols; row <= max / mCols; ++row)
+        {
+            for (auto col = min % mCols; col <= max % mCols; ++col)
+            {
+                auto cell = row * mCols + col;
+                for (auto i = mStart[cell]; i != mStart[cell + 1]; ++i)
+                {
+                    if (!fn(mOrder[i])) { return; }
+                }
+            }
+        }
+    }
+
+    uint32_t Cols() const { return mCols; }
+    uint32_t Rows() const { return mRows; }
+
+private:
+    static constexpr float kFar = 1e30f;
+
+    struct Node {
+        float    mDist;
+        uint32_t mCell;
+
+        bool operator < (const Node & v) const
+        {
+            return mDist > v.mDist;
+        }
+    };
+
+    bool IsOpen(int col, int row) const
+    {
+        return col >= 0 && row >= 0 && col < (int)mCols && row < (int)mRows
+            && mBlock[row * mCols + col] == 0;
+    }
+
+    //  8邻接Dijkstra, 对角需两侧均可通行
+    void Integrate()
+    {
+        static const int   kDX[]   = { 1, -1, 0, 0, 1, 1, -1, -1 };
+        static const int   kDY[]   = { 0, 0, 1, -1, 1, -1, 1, -1 };
+        static const float kCost[] = { 1, 1, 1, 1, 1.4142f, 1.4142f, 1.4142f, 1.4142f };
+
+        std::fill(mDist.begin(), mDist.end(), kFar);
+        mHeap.clear();
+        mDist[mGoal] = 0;
+        mHeap.push_back({ 0, mGoal });
+        while (!mHeap.empty())
+        {
+            std::pop_heap(mHeap.begin(), mHeap.end());
+            auto node = mHeap.back();
+            mHeap.pop_back();
+            if (node.mDist > mDist[node.mCell]) { continue; }
+
+            auto col = (int)(node.mCell % mCols);
+            auto row = (int)(node.mCell / mCols);
+            for (auto i = 0; i != 8; ++i)
+            {
+                auto c = col + kDX[i], r = row + kDY[i];
+                if (!IsOpen(c, r)) { continue; }
+                if (i >= 4 && (!IsOpen(c, row) || !IsOpen(col, r))) { continue; }
+
+                auto next = (uint32_t)(r * mCols + c);
+                auto dist = node.mDist + kCost[i];
+                if (dist < mDist[next])
+                {
+                    mDist[next] = dist;
+                    mHeap.push_back({ dist, next });
+                    std::push_heap(mHeap.begin(), mHeap.end());
+                }
+            }
+        }
+    }
+
+    //  距离场中心差分取下降方向, 不可达或越界的邻格按本格距离计
+    void Gradient()
+    {
+        for (uint32_t row = 0; row != mRows; ++row)
+        {
+            for (uint32_t col = 0; col != mCols; ++col)
+            {
+                auto cell = row * mCols + col;
+                auto self = mDist[cell];
+                mDirX[cell] = 0;
+                mDirY[cell] = 0;
+                if (self == kFar || cell == mGoal) { continue; }
+
+                auto fn = [&] (int c, int r)
+                {
+                    return IsOpen(c, r) && mDist[r * mCols + c] != kFar ? mDist[r * mCols + c] : self;
+                };
+                auto dir = Vec2(fn(col - 1, row) - fn(col + 1, row),
+                                fn(col, row - 1) - fn(col, row + 1));
+                if (Math::LengthSqr(dir) != 0)
+                {
+                    dir = Math::Normal(dir);
+                    mDirX[cell] = dir.x;
+                    mDirY[cell] = dir.y;
+                }
+            }
+        }
+    }
+
+    //  按格计数排序, 同时得到格密度与格内代理表
+    void Bucket(const Agents & agents)
+    {
+        std::fill(mCount.begin(), mCount.end(), 0);
+        for (auto cell : agents.mCell) { ++mCount[cell]; }
+
+        mStart[0] = 0;
+        for (size_t i = 0; i != mCount.size(); ++i) { mStart[i + 1] = mStart[i] + mCount[i]; }
+
+        mOrder.resize(agents.Size());
+        for (size_t i = 0; i != mCount.size(); ++i) { mCount[i] = mStart[i]; }
+        for (uint32_t i = 0; i != agents.Size(); ++i) { mOrder[mCount[agents.mCell[i]]++] = i; }
+        for (size_t i = 0; i != mCount.size(); ++i) { mCount[i] -= mStart[i]; }
+    }
+
+    //  分离: 沿格密度下降方向
+    void Separate(float separate)
+    {
+        auto fn = [&] (int c, int r, uint32_t self)
+        {
+            return c >= 0 && r >= 0 && c < (int)mCols && r < (int)mRows ? mCount[r * mCols + c] : self;
+        };
+        for (uint32_t row = 0; row != mRows; ++row)
+        {
+            for (uint32_t col = 0; col != mCols; ++col)
+            {
+                auto cell = row * mCols + col;
+                auto self = mCount[cell];
+                mSepX[cell] = separate * ((float)fn(col - 1, row, self) - (float)fn(col + 1, row, self));
+                mSepY[cell] = separate * ((float)fn(col, row - 1, self) - (float)fn(col, row + 1, self));
+            }
+        }
+    }
+
+    Vec2     mRange;
+    float    mCell;
+    float    mInv;
+    uint32_t mCols;
+    uint32_t mRows;
+    uint32_t mGoal;
+    bool     mIsDirty;
+
+    std::vector<uint8_t>  mBlock;           //  阻挡
+    std::vector<float>    mDist;            //  到目标的距离
+    std::vector<float>    mDirX, mDirY;     //  流向
+    std::vector<float>    mSepX, mSepY;     //  分离速度
+    std::vector<uint32_t> mCount;           //  格内代理数
+    std::vector<uint32_t> mStart;           //  格内代理在mOrder中的起点
+    std::vector<uint32_t> mOrder;           //  按格排序的代理下标
+    std::vector<Node>     mHeap;
+};
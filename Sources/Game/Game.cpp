@@ -1,61 +1,526 @@
 #pragma once
 
 #include "Game.h"
-#include "play.h"
+#include "Play.h"
 #include "Component.h"
+#include "Memory.h"
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
+#ifdef SIMPLE2D_SOFT
+#include "Simple2DSoft.h"
+#endif
+
 
 namespace Game {
-    Contex mCtx;
+    //  主世界供窗口游戏使用, 每个线程绑定一个当前世界, 默认主世界
+    Contex mMain;
+    thread_local Contex * mCtx = &mMain;
+
+    //  模拟线程
+    std::thread       mSimThread;
+    std::atomic<bool> mSimQuit;
+
+    float ElapsedMS(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    //  分段计时, 返回上一段耗时并开始下一段
+    float Lap(std::chrono::steady_clock::time_point & since)
+    {
+        auto now = std::chrono::steady_clock::now();
+        auto ms  = std::chrono::duration<float, std::milli>(now - since).count();
+        since = now;
+        return ms;
+    }
+
+    //  启动时刻, 统计首帧耗时
+    const auto mLaunch = std::chrono::steady_clock::now();
+
+    //  菜单使用的贴图, 首帧前同步加载, 其余后台加载
+    const char * mMenuImages[] = { "StarLayer" };
+
+    void AppendImage(const std::string & name, Simple2D::Image * image)
+    {
+        mCtx->mImages.emplace(name, image);
+
+        //  每张贴图生成同名单帧动画
+        CreateClip(name, { name }, 1.0f, false);
+    }
+
+    void LoadFiles()
+    {
+        static const char * sImages[] = {
+            "Moon", "Enemy_1", "Enemy_2", "Enemy_3", "Upgrade", "Player_1", "Player_2", "Player_3",
+            "StarLayer", "EnemyBullet", "Explosion_1", "Explosion_2", "Meteorite_1", "Meteorite_2",
+            "Meteorite_3", "Meteorite_4", "PlayerBullet",
+        };
+
+        mCtx->mFont24 = Simple2D::CreateFont("../../Content/Fonts/AGENCYB.TTF", 24);
+        mCtx->mFont36 = Simple2D::CreateFont("../../Content/Fonts/AGENCYB.TTF", 36);
+        mCtx->mFont72 = Simple2D::CreateFont("../../Content/Fonts/AGENCYB.TTF", 72);
+
+        for (auto name : sImages)
+        {
+            AppendImage(name, Simple2D::CreateImage(std::string("../../Content/Textures/") + name + ".png"));
+        }
+    }
+
+#ifdef SIMPLE2D_SOFT
+    void LoadArchive()
+    {
+        auto & archive = mCtx->mArchive;
+        auto & loading = mCtx->mLoading;
+
+        auto font = archive.Find("AGENCYB");
+        mCtx->mFont24 = Simple2D::CreateFontFromMemory(archive.Data(*font), (size_t)font->mSize, 24);
+        mCtx->mFont36 = Simple2D::CreateFontFromMemory(archive.Data(*font), (size_t)font->mSize, 36);
+        mCtx->mFont72 = Simple2D::CreateFontFromMemory(archive.Data(*font), (size_t)font->mSize, 72);
+
+        auto create = [&archive] (const Archive::Entry & entry)
+        {
+            return Simple2D::CreateImageFromMemory(archive.Data(entry), (int)entry.mWidth, (int)entry.mHeight);
+        };
+
+        for (uint i = 0; i != archive.Count(); ++i)
+        {
+            auto & entry = archive.At(i);
+            if (entry.mKind != Archive::Kind::kImage) { continue; }
+
+            auto menu = std::find_if(std::begin(mMenuImages), std::end(mMenuImages),
+                [&entry] (const char * name) { return std::strcmp(name, entry.mName) == 0; });
+            if (menu != std::end(mMenuImages))
+            {
+                AppendImage(entry.mName, create(entry));
+            }
+            else
+            {
+                loading.mEntrys.push_back(&entry);
+            }
+        }
+
+        //  工作线程领取条目, 完成后由UpdateLoad在模拟线程登记
+        auto count = (uint)loading.mEntrys.size();
+        loading.mImages.resize(count);
+        loading.mNext = 0;
+        loading.mDone = 0;
+        auto threads = std::min(count, std::max(1u, std::thread::hardware_concurrency()));
+        for (uint t = 0; t != threads; ++t)
+        {
+            loading.mThreads.emplace_back([&loading, create, count]
+            {
+                for (auto i = loading.mNext++; i < count; i = loading.mNext++)
+                {
+                    loading.mImages[i] = create(*loading.mEntrys[i]);
+                    ++loading.mDone;
+                }
+            });
+        }
+    }
+#endif
+
+    void LoadAssets()
+    {
+        //  资源包不存在时逐个加载原始文件
+#ifdef SIMPLE2D_SOFT
+        if (mCtx->mArchive.Open("../../Content/Content.pak"))
+        {
+            LoadArchive();
+        }
+        else
+#endif
+        {
+            LoadFiles();
+        }
+
+        //  关卡优先映射编译结果, 不存在时读源文件编译
+        std::string error;
+        if (mCtx->mLevel.Open("../../Content/Scenes/Level.scene")
+            || mCtx->mLevel.Load("../../Content/Scenes/Level.txt", error))
+        {
+            mCtx->mScene = &mCtx->mLevel;
+        }
+        else
+        {
+            std::cerr << error << std::endl;
+        }
+    }
 
     void GameInit()
     {
-        //  初始化资源
-        mCtx.mFont24 = Simple2D::CreateFont("../../Content/Fonts/AGENCYB.TTF", 24);
-        mCtx.mFont36 = Simple2D::CreateFont("../../Content/Fonts/AGENCYB.TTF", 36);
-        mCtx.mFont72 = Simple2D::CreateFont("../../Content/Fonts/AGENCYB.TTF", 72);
-
-        mCtx.mImages.emplace(std::make_pair("Moon", Simple2D::CreateImage("../../Content/Textures/Moon.png")));
-        mCtx.mImages.emplace(std::make_pair("Enemy_1", Simple2D::CreateImage("../../Content/Textures/Enemy_1.png")));
-        mCtx.mImages.emplace(std::make_pair("Enemy_2", Simple2D::CreateImage("../../Content/Textures/Enemy_2.png")));
-        mCtx.mImages.emplace(std::make_pair("Enemy_3", Simple2D::CreateImage("../../Content/Textures/Enemy_3.png")));
-        mCtx.mImages.emplace(std::make_pair("Upgrade", Simple2D::CreateImage("../../Content/Textures/Upgrade.png")));
-        mCtx.mImages.emplace(std::make_pair("Player_1", Simple2D::CreateImage("../../Content/Textures/Player_1.png")));
-        mCtx.mImages.emplace(std::make_pair("Player_2", Simple2D::CreateImage("../../Content/Textures/Player_2.png")));
-        mCtx.mImages.emplace(std::make_pair("Player_3", Simple2D::CreateImage("../../Content/Textures/Player_3.png")));
-        mCtx.mImages.emplace(std::make_pair("StarLayer", Simple2D::CreateImage("../../Content/Textures/StarLayer.png")));
-        mCtx.mImages.emplace(std::make_pair("EnemyBullet", Simple2D::CreateImage("../../Content/Textures/EnemyBullet.png")));
-        mCtx.mImages.emplace(std::make_pair("Explosion_1", Simple2D::CreateImage("../../Content/Textures/Explosion_1.png")));
-        mCtx.mImages.emplace(std::make_pair("Explosion_2", Simple2D::CreateImage("../../Content/Textures/Explosion_2.png")));
-        mCtx.mImages.emplace(std::make_pair("Meteorite_1", Simple2D::CreateImage("../../Content/Textures/Meteorite_1.png")));
-        mCtx.mImages.emplace(std::make_pair("Meteorite_2", Simple2D::CreateImage("../../Content/Textures/Meteorite_2.png")));
-        mCtx.mImages.emplace(std::make_pair("Meteorite_3", Simple2D::CreateImage("../../Content/Textures/Meteorite_3.png")));
-        mCtx.mImages.emplace(std::make_pair("Meteorite_4", Simple2D::CreateImage("../../Content/Textures/Meteorite_4.png")));
-        mCtx.mImages.emplace(std::make_pair("PlayerBullet", Simple2D::CreateImage("../../Content/Textures/PlayerBullet.png")));
-
-        //  初始化全局变量
-        mCtx.mGID       = 0;
-        mCtx.mInput     = 0;
-        mCtx.mLastTime  = Simple2D::GetGameTime();
-
-        mCtx.mPlay.mRange = Vec2((float)mWindowW, 
-                                 (float)mWindowH);
-        mCtx.mPlay.mState = PlayState::kMenu;
+        LoadAssets();
+        BindWorld(mCtx);
+        mCtx->mRandom.seed(std::random_device()());
+        mCtx->mLastTime = Simple2D::GetGameTime();
+
+        //  性能统计, 无窗口运行时用SHOOTER_CSV导出
+        mCtx->mStats.mStart = mCtx->mLastTime;
+        if (auto csv = std::getenv("SHOOTER_CSV"))
+        {
+            mCtx->mStats.mCSV.open(csv);
+            mCtx->mStats.mCSV << "time,fps,input_ms,update_ms,collide_ms,timer_ms,sim_ms,render_ms,"
+                                 "actors,pairs_tested,pairs_hit,allocs,alloc_bytes,resident_bytes\n";
+        }
+
+        WorldInit();
+    }
+
+    //  碰撞层矩阵, 与碰撞组件的mSelf/mMask对应
+    void InitLayers(Collide & collide)
+    {
+        auto interact = [&collide] (CollisionLayer a, CollisionLayer b)
+        {
+            collide.SetInteract((uint)a, (uint)b, true);
+        };
+        interact(CollisionLayer::kPlayer,       CollisionLayer::kEnemy);
+        interact(CollisionLayer::kPlayer,       CollisionLayer::kEnemyBullet);
+        interact(CollisionLayer::kPlayerBullet, CollisionLayer::kEnemy);
+        interact(CollisionLayer::kPlayerBullet, CollisionLayer::kEnemyBullet);
+    }
+
+    //  世界的初始状态, 主世界与无头世界共用, 资源与时钟已就绪
+    void WorldInit()
+    {
+        mCtx->mGID   = 0;
+        mCtx->mInput = 0;
+        mCtx->mDraw  = &mCtx->mFrames.Back();
+        mCtx->mScript.Init(&mCtx->mTimer);
+
+        mCtx->mPlay.mRange = Vec2((float)mWindowW,
+                                  (float)mWindowH);
+        mCtx->mPlay.mState = PlayState::kMenu;
+
+        //  碰撞层矩阵
+        InitLayers(mCtx->mPlay.mCollide);
+
+        //  死亡时爆炸
+        mCtx->mPlay.mEvents.Subscribe<DieEvent>([] (const DieEvent * events, size_t count)
+        {
+            for (size_t i = 0; i != count; ++i)
+            {
+                mCtx->mPlay.mParticle.Emit((uint)EffectEnum::kBoom, events[i].mCoord);
+            }
+        });
 
         GameStart();
     }
 
+    //  依赖全部贴图的部分, 资源加载完成后调用
+    void WorldReady()
+    {
+        //  粒子发射器
+        {
+            Particle::Emitter boom;
+            boom.mFrames.push_back(mCtx->mImages.at("Explosion_1"));
+            boom.mFrames.push_back(mCtx->mImages.at("Explosion_2"));
+            boom.mInterval = 0.1f;
+            boom.mLife     = 0.2f;
+            boom.mSpeed    = Vec2(-500, 0);
+            boom.mSpread   = 0;
+            boom.mCount    = 1;
+            mCtx->mPlay.mParticle.SetEmitter((uint)EffectEnum::kBoom, boom);
+        }
+
+        Play::CreatePrefabs();
+        mCtx->mLoading.mIsReady = true;
+    }
+
+    Contex * CreateWorld(const Contex & assets, uint seed, float step)
+    {
+        assert(step > 0);
+        auto world = new Contex();
+        world->mFont24 = assets.mFont24;
+        world->mFont36 = assets.mFont36;
+        world->mFont72 = assets.mFont72;
+        world->mImages = assets.mImages;
+        world->mClips  = assets.mClips;
+        world->mScene  = assets.mScene;
+        world->mStep   = step;
+        world->mRandom.seed(seed);
+        world->mAgent  = { 0, Observe::kFullHp, Observe::kFullHp };
+
+        auto last = BindWorld(world);
+        WorldInit();
+        WorldReady();
+
+        //  初始Actor立即进场, 首步的输入即可被菜单响应
+        UpdateCommand();
+        BindWorld(last);
+        return world;
+    }
+
+    void DestroyWorld(Contex * world)
+    {
+        auto last = BindWorld(world);
+        auto & play = world->mPlay;
+        for (auto & command : play.mCommands)
+        {
+            if (command.mKind == GamePlay::Command::Kind::kAppendActor) { delete command.mActor; }
+        }
+        for (auto & pair : play.mActors) { delete pair.second; }
+        for (auto & pair : world->mPrefabs) { delete pair.second; }
+
+        //  脚本已随组件取消, 唤醒一次以释放协程帧
+        world->mScript.Update();
+        world->mTimer.Call(INFINITY);
+        BindWorld(last);
+        delete world;
+    }
+
+    //  分片工作线程, 按需补足, 跨调用复用, 退出时回收
+    //  同一时刻只有一个调用方, 调用方自己执行第0片
+    class Workers {
+    public:
+        using Shard = void (*)(const void * context, uint index);
+
+        ~Workers()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mQuit = true;
+            }
+            mWake.notify_all();
+            for (auto & thread : mThreads) { thread.join(); }
+        }
+
+        void Run(uint threads, Shard shard, const void * context)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            while (mThreads.size() + 1 < threads)
+            {
+                mThreads.emplace_back(&Workers::Loop, this, (uint)mThreads.size() + 1, mRound);
+            }
+            mShard   = shard;
+            mContext = context;
+            mCount   = threads;
+            mPending = threads - 1;
+            ++mRound;
+            lock.unlock();
+            mWake.notify_all();
+
+            shard(context, 0);
+
+            lock.lock();
+            mDone.wait(lock, [this] { return mPending == 0; });
+        }
+
+    private:
+        void Loop(uint index, uint64_t round)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            while (true)
+            {
+                mWake.wait(lock, [&] { return mQuit || mRound != round; });
+                if (mQuit) { return; }
+                round = mRound;
+                if (index >= mCount) { continue; }
+
+                auto shard = mShard; auto context = mContext;
+                lock.unlock();
+                shard(context, index);
+                lock.lock();
+                if (--mPending == 0) { mDone.notify_one(); }
+            }
+        }
+
+        std::mutex               mMutex;
+        std::condition_variable  mWake;
+        std::condition_variable  mDone;
+        std::vector<std::thread> mThreads;
+        Shard        mShard   = nullptr;
+        const void * mContext = nullptr;
+        uint         mCount   = 0;
+        uint         mPending = 0;
+        uint64_t     mRound   = 0;      //  每次Run加一, 工作线程据此领取新一轮
+        bool         mQuit    = false;
+    };
+
+    Workers mWorkers;
+
+    //  按世界静态分片, 世界之间没有共享的可变状态
+    //  threads为1时在调用线程完成, 不唤醒工作线程
+    template <class Fn>
+    void ShardWorlds(size_t count, uint threads, Fn fn)
+    {
+        threads = std::max(1u, std::min(threads, (uint)count));
+        auto shard = [=] (uint index)
+        {
+            auto last = mCtx;
+            for (auto i = (size_t)index; i < count; i += threads) { fn(i); }
+            BindWorld(last);
+        };
+
+        if (threads == 1) { shard(0); return; }
+        mWorkers.Run(threads, [] (const void * context, uint index)
+        {
+            (*(const decltype(shard) *)context)(index);
+        }, &shard);
+    }
+
+    void StepWorlds(Contex * const * worlds, size_t count, uint ticks, uint threads)
+    {
+        ShardWorlds(count, threads, [=] (size_t i)
+        {
+            BindWorld(worlds[i]);
+            for (uint tick = 0; tick != ticks; ++tick) { GameStep(); }
+        });
+    }
+
+    //  主角与Boss不在场时, 按结局取0或满血, 菜单与结算期间奖励为0
+    void ObserveHp(Contex * world, int & hero, int & boss)
+    {
+        auto & play = world->mPlay;
+        hero = play.mHero != nullptr ? ((Play::Hero *)play.mHero)->mHp : (play.mState == PlayState::kFailed  ? 0 : Observe::kFullHp);
+        boss = play.mBoss != nullptr ? ((Play::Boss *)play.mBoss)->mHp : (play.mState == PlayState::kSuccess ? 0 : Observe::kFullHp);
+    }
+
+    bool IsDone(const Contex * world)
+    {
+        return world->mPlay.mState == PlayState::kSuccess
+            || world->mPlay.mState == PlayState::kFailed;
+    }
+
+    void ObserveWorld(Contex * world, float * obs)
+    {
+        auto & play = world->mPlay;
+        auto rx = 1.0f / play.mRange.x;
+        auto ry = 1.0f / play.mRange.y;
+        std::fill(obs, obs + Observe::kSize, 0.0f);
+
+        auto hero = 0, boss = 0;
+        ObserveHp(world, hero, boss);
+        obs[Observe::kHero + 2] = (float)hero / Observe::kFullHp;
+        obs[Observe::kBoss    ] = (float)boss / Observe::kFullHp;
+
+        if (play.mBoss != nullptr)
+        {
+            auto & items = ((Play::Boss *)play.mBoss)->mItems;
+            auto out = obs + Observe::kBoss + 1;
+            for (size_t i = 0; i != std::min(items.size(), Observe::kSegments); ++i)
+            {
+                auto & coord = items[i].mActor->mTrans->Coord();
+                out[i * 2    ] = coord.x * rx;
+                out[i * 2 + 1] = coord.y * ry;
+            }
+        }
+
+        if (play.mHero == nullptr)
+        {
+            return;
+        }
+        auto coord = play.mHero->mOwner->mTrans->Coord();
+        obs[Observe::kHero    ] = coord.x * rx;
+        obs[Observe::kHero + 1] = coord.y * ry;
+
+        //  最近邻查询写入栈上数组, 按距离升序
+        Collide::Hit hits[Observe::kBullets];
+        auto count = play.mCollide.Nearest(coord, 1u << (uint)CollisionLayer::kEnemyBullet, hits, Observe::kBullets);
+        for (size_t i = 0; i != count; ++i)
+        {
+            auto body   = hits[i].mBody;
+            auto bullet = ((CompCollision *)body->mUser)->mOwner->GetComponent<Play::Bullet>();
+            auto out    = obs + Observe::kBullet + i * 5;
+
+            //  关卡可把无Bullet组件的预制体放在敌方子弹层, 该项保持为0
+            if (bullet == nullptr) { continue; }
+            out[0] = 1.0f;
+            out[1] = (body->mCoord.x - coord.x) * rx;
+            out[2] = (body->mCoord.y - coord.y) * ry;
+            out[3] = bullet->mSpeed.x * rx;
+            out[4] = bullet->mSpeed.y * ry;
+        }
+    }
+
+    void StepBatch(Contex * const * worlds, size_t count, const uint * actions, uint ticks,
+                   float * obs, StepResult * results, uint threads)
+    {
+        ShardWorlds(count, threads, [=] (size_t i)
+        {
+            auto world = worlds[i];
+            auto & agent = world->mAgent;
+            BindWorld(world);
+
+            //  动作与上一步的差异转为按键事件, 与窗口输入走同一路径, 菜单与HUD照常响应
+            auto action = actions[i];
+            for (uint k = 0; k != kInputCount; ++k)
+            {
+                auto bit = 1u << k;
+                if (((action ^ agent.mAction) & bit) != 0)
+                {
+                    world->mInputs.Push({ bit, (action & bit) != 0, world->mLastTime });
+                }
+            }
+            agent.mAction = action;
+
+            for (uint tick = 0; tick != ticks && !IsDone(world); ++tick) { GameStep(); }
+
+            auto hero = 0, boss = 0;
+            ObserveHp(world, hero, boss);
+            results[i].mReward = (float)(agent.mBossHp - boss) - (float)(agent.mHeroHp - hero);
+            results[i].mIsDone = IsDone(world);
+            agent.mHeroHp = hero;
+            agent.mBossHp = boss;
+            ObserveWorld(world, obs + i * Observe::kSize);
+        });
+    }
+
     void GameStep()
     {
-        auto now = Simple2D::GetGameTime();
-        mCtx.mDiffTime = now - mCtx.mLastTime;
-        mCtx.mLastTime = now;
+        auto start = std::chrono::steady_clock::now();
+        auto now = mCtx->mStep > 0 ? mCtx->mLastTime + mCtx->mStep : Simple2D::GetGameTime();
+        mCtx->mDiffTime = now - mCtx->mLastTime;
+        mCtx->mLastTime = now;
 
+        mCtx->mDraw = &mCtx->mFrames.Back();
+        mCtx->mDraw->Clear();
+        mCtx->mDraw->mFrame = ++mCtx->mFrame;
+
+        auto & frame = mCtx->mStats.mFrame;
+        auto & tags  = mCtx->mStats.mTags;
+        auto total = Memory::Total();
+        for (size_t i = 0; i != (size_t)Memory::Tag::kCount; ++i) { tags[i] = Memory::Total((Memory::Tag)i); }
+        auto phase = std::chrono::steady_clock::now();
+        UpdateLoad();
         UpdateInput();
+        UpdateEvent();
+        frame.mInput = Lap(phase);
+
         UpdateActor();
+        UpdateTransform();
+        frame.mUpdate = Lap(phase);
+
+        UpdateCollide();
+        frame.mCollide = Lap(phase);
 
-        mCtx.mTimer.Call(Simple2D::GetGameTime());
+        UpdateEvent();
+        UpdateParticle();
+        frame.mUpdate += Lap(phase);
+
+        {
+            Memory::Scope scope(Memory::Tag::kTimer);
+            mCtx->mScript.Update();
+            mCtx->mTimer.Call(mCtx->mLastTime);
+        }
+        frame.mTimer = Lap(phase);
+
+        frame.mSim    = ElapsedMS(start);
+        frame.mAllocs = (float)(Memory::Total().mCount - total.mCount);
+        frame.mBytes  = (float)(Memory::Total().mBytes - total.mBytes);
+        for (size_t i = 0; i != (size_t)Memory::Tag::kCount; ++i)
+        {
+            auto now = Memory::Total((Memory::Tag)i);
+            tags[i] = { now.mCount - tags[i].mCount, now.mBytes - tags[i].mBytes };
+        }
+        UpdateStats();
+
+        mCtx->mDraw->mSimTime = frame.mSim;
+        mCtx->mFrames.Publish();
     }
 
     void GameStart()
@@ -69,9 +534,88 @@ namespace Game {
             auto actor = AppendActor();
             actor->AddComponent<Play::Menu>();
         }
+
+        {
+            auto actor = AppendActor();
+            actor->AddComponent<Play::Hud>();
+        }
+    }
+
+    void UpdateLoad()
+    {
+        Memory::Scope scope(Memory::Tag::kLoad);
+        auto & loading = mCtx->mLoading;
+        if (loading.mIsReady || loading.mDone != loading.mEntrys.size())
+        {
+            return;
+        }
+
+        for (auto & thread : loading.mThreads) { thread.join(); }
+        for (size_t i = 0; i != loading.mEntrys.size(); ++i)
+        {
+            AppendImage(loading.mEntrys[i]->mName, loading.mImages[i]);
+        }
+        loading.mThreads.clear();
+
+        WorldReady();
+        std::cout << "assets ready " << ElapsedMS(mLaunch) << " ms" << std::endl;
     }
 
     void UpdateInput()
+    {
+        Memory::Scope scope(Memory::Tag::kInput);
+        auto now = mCtx->mLastTime;
+        auto & list = *mCtx->mDraw;
+        mCtx->mPressed = 0;
+
+        //  按时间顺序应用本帧之前到达的事件, 统计输入到模拟的延迟
+        //  延迟用打时间戳的同一时钟: 固定步长的世界按模拟时间, 实时世界按游戏时间
+        auto clock = mCtx->mStep > 0 ? now : Simple2D::GetGameTime();
+        KeyEvent event;
+        while (mCtx->mInputs.Pop(event))
+        {
+            auto latency = (clock - event.mTime) * 1000;
+            list.mInputCount   += 1;
+            list.mInputLatency += latency;
+            list.mInputMaxLatency = std::max(list.mInputMaxLatency, latency);
+
+            mCtx->mPlay.mEvents.Publish(event);
+            if (event.mIsDown)
+            {
+                mCtx->mInput   |= event.mInput;
+                mCtx->mPressed |= event.mInput;
+                for (uint i = 0; i != kInputCount; ++i)
+                {
+                    if ((event.mInput & (1u << i)) != 0) { mCtx->mPressTime[i] = std::min(event.mTime, now); }
+                }
+            }
+            else
+            {
+                mCtx->mInput &= ~event.mInput;
+            }
+        }
+    }
+
+    //  派发阶段: 输入之后, 碰撞之后
+    void UpdateEvent()
+    {
+        Memory::Scope scope(Memory::Tag::kEvent);
+        mCtx->mPlay.mEvents.Dispatch();
+    }
+
+    float InputTime(uint mask)
+    {
+        auto time = 0.0f;
+        for (uint i = 0; i != kInputCount; ++i)
+        {
+            if ((mask & (1u << i)) != 0) { time = std::max(time, mCtx->mPressTime[i]); }
+        }
+        return time;
+    }
+
+    //  在泵送窗口消息的线程采样, 只在状态变化时入队
+    //  按键状态随RefreshWindowBuffer更新, 时间戳的精度为一帧
+    void SampleInput()
     {
         static std::pair<Simple2D::KeyCode, InputEnum> sInputs[] = {
             { Simple2D::KEY_A, InputEnum::kDirL },
@@ -79,82 +623,634 @@ namespace Game {
             { Simple2D::KEY_W, InputEnum::kDirU },
             { Simple2D::KEY_S, InputEnum::kDirD },
             { Simple2D::KEY_SPACE, InputEnum::kFire },
+            { Simple2D::KEY_H, InputEnum::kHud },
         };
 
+        static uint sKeys = 0;
+        auto time = Simple2D::GetGameTime();
         for (const auto & pair : sInputs)
         {
-            if (Simple2D::IsKeyPressed(pair.first))
+            auto input = (uint)pair.second;
+            if ((sKeys & input) == 0 && Simple2D::IsKeyPressed(pair.first))
+            {
+                sKeys |= input;
+                mCtx->mInputs.Push({ input, true, time });
+            }
+            else if ((sKeys & input) != 0 && Simple2D::IsKeyReleased(pair.first))
             {
-                mCtx.mInput |=  (int)pair.second;
+                sKeys &= ~input;
+                mCtx->mInputs.Push({ input, false, time });
             }
-            if (Simple2D::IsKeyReleased(pair.first))
+        }
+    }
+
+    void RenderFrame(Simple2D::Window * window)
+    {
+        static std::string sText;
+        static float sSimTime    = 0;
+        static float sRenderTime = 0;
+        static uint  sFrames     = 0;
+        static uint  sInputCount = 0;
+        static float sLatency    = 0;
+        static float sMaxLatency = 0;
+        static uint  sLastFrame  = 0;
+        static auto  sReport     = std::chrono::steady_clock::now();
+        static bool  sIsFirst    = true;
+
+        auto start = std::chrono::steady_clock::now();
+        auto & list = mCtx->mFrames.Acquire();
+        list.Submit(sText);
+        Simple2D::RefreshWindowBuffer(window);
+
+        if (sIsFirst && !list.mCommands.empty())
+        {
+            std::cout << "first frame " << ElapsedMS(mLaunch) << " ms" << std::endl;
+            sIsFirst = false;
+        }
+
+        //  模拟与渲染耗时分开统计, 每秒输出平均值
+        if (list.mFrame != sLastFrame)
+        {
+            sSimTime    += list.mSimTime;
+            sInputCount += list.mInputCount;
+            sLatency    += list.mInputLatency;
+            sMaxLatency  = std::max(sMaxLatency, list.mInputMaxLatency);
+            sLastFrame   = list.mFrame;
+        }
+        mCtx->mStats.mRender.store(ElapsedMS(start), std::memory_order_relaxed);
+        sRenderTime += ElapsedMS(start);
+        sFrames     += 1;
+        if (ElapsedMS(sReport) >= 1000)
+        {
+            std::cout << "sim " << sSimTime / sFrames << " ms, "
+                      << "render " << sRenderTime / sFrames << " ms";
+            if (sInputCount != 0)
             {
-                mCtx.mInput &= ~(int)pair.second;
+                std::cout << ", input " << sInputCount << " events, latency "
+                          << sLatency / sInputCount << " ms (max " << sMaxLatency << " ms)";
             }
+            std::cout << std::endl;
+            sSimTime = sRenderTime = sLatency = sMaxLatency = 0; sFrames = sInputCount = 0;
+            sReport = std::chrono::steady_clock::now();
+        }
+    }
+
+    void SimulateStart()
+    {
+        mSimQuit = false;
+        mSimThread = std::thread([]
+        {
+            BindWorld(&mMain);
+            while (!mSimQuit)
+            {
+                GameStep();
+
+                //  领先渲染线程至多一帧
+                while (!mCtx->mFrames.IsConsumed() && !mSimQuit)
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }
+        });
+    }
+
+    static const char * sStateNames[] = {
+        "menu", "init", "idle", "battle0", "battle1", "battle2", "success", "failed",
+    };
+
+    void SimulateStop()
+    {
+        mSimQuit = true;
+        mSimThread.join();
+
+        //  事件流量
+        for (auto & stat : mCtx->mPlay.mEvents.Stats())
+        {
+            std::cout << "event " << stat.mName << ": " << stat.mCount << " in "
+                      << stat.mBatch << " batches, " << stat.mTime << " ms" << std::endl;
+        }
+
+        //  内存: 模拟线程各子系统与组件类型的累计分配, 各状态常驻峰值
+        for (size_t i = 0; i != (size_t)Memory::Tag::kCount; ++i)
+        {
+            auto & count = mCtx->mStats.mTagTotal[i];
+            if (count.mCount == 0) { continue; }
+            std::cout << "alloc " << Memory::TagName((Memory::Tag)i) << ": "
+                      << count.mCount << " blocks, " << count.mBytes << " bytes" << std::endl;
+        }
+        for (auto & pair : mCtx->mPlay.mCompMemory)
+        {
+            std::cout << "alloc " << pair.first.name() << ": "
+                      << pair.second.mCount << " blocks, " << pair.second.mBytes << " bytes" << std::endl;
+        }
+
+        auto & peaks = mCtx->mStats.mPeaks;
+        peaks[(uint)mCtx->mPlay.mState] = std::max(peaks[(uint)mCtx->mPlay.mState], Memory::Peak());
+        for (uint i = 0; i != kPlayStateCount; ++i)
+        {
+            if (peaks[i] == 0) { continue; }
+            std::cout << "peak " << sStateNames[i] << ": " << peaks[i] / 1024 << " KB" << std::endl;
         }
     }
 
     void UpdateActor()
     {
-        //  新增
-        for (auto actor : mCtx.mPlay.mAppends)
+        Memory::Scope scope(Memory::Tag::kActor);
+        UpdateCommand();
+        UpdateCull();
+        UpdateAnimate();
+
+        //  只遍历活跃组件, 结构变更在帧边界生效, 遍历期间列表不变
+        //  循环内只允许打了标签的分配, 如生成Actor与提交命令
+        Memory::NoAlloc noAlloc;
+        auto & ticks = mCtx->mPlay.mTicks;
+        for (size_t i = 0; i != ticks.size(); ++i)
+        {
+            if (ticks[i] != nullptr) { ticks[i]->OnUpdate(mCtx->mDiffTime); }
+        }
+    }
+
+    //  包围半径和出界边距在进入场景时确定
+    void CullEnter(Actor * actor)
+    {
+        auto & track = mCtx->mPlay.mCull.mTrack;
+        if (actor->mCull == kNoIndex && (actor->mBound != 0 || actor->mOutDelete != 0))
+        {
+            actor->mCull = track.size();
+            track.push_back(actor);
+        }
+    }
+
+    void CullLeave(Actor * actor)
+    {
+        auto & track = mCtx->mPlay.mCull.mTrack;
+        if (actor->mCull != kNoIndex)
+        {
+            track.back()->mCull = actor->mCull;
+            track[actor->mCull] = track.back();
+            track.pop_back();
+            actor->mCull = kNoIndex;
+        }
+    }
+
+    void TickEnter(Component * comp)
+    {
+        auto & count = mCtx->mPlay.mTickCounts[comp->GetType()];
+        if (comp->IsTick() && !comp->mIsSleep)
+        {
+            comp->mTick = mCtx->mPlay.mTicks.size();
+            mCtx->mPlay.mTicks.push_back(comp);
+            count.mTick += 1;
+        }
+        else
+        {
+            count.mSleep += 1;
+        }
+    }
+
+    void TickLeave(Component * comp)
+    {
+        auto & count = mCtx->mPlay.mTickCounts[comp->GetType()];
+        if (comp->mTick != kNoIndex)
+        {
+            mCtx->mPlay.mTicks[comp->mTick] = nullptr;
+            mCtx->mPlay.mIsTickDirty = true;
+            comp->mTick = kNoIndex;
+            count.mTick -= 1;
+        }
+        else
+        {
+            count.mSleep -= 1;
+        }
+    }
+
+    //  唤醒的组件排在更新列表末尾
+    void TickSleep(Component * comp, bool isSleep)
+    {
+        if (comp->mIsSleep == isSleep || comp->mOwner->mIsDelete || comp->mIsDelete)
+        {
+            return;
+        }
+        TickLeave(comp);
+        comp->mIsSleep = isSleep;
+        TickEnter(comp);
+    }
+
+    void UpdateCommand()
+    {
+        using Kind = GamePlay::Command::Kind;
+        auto & play  = mCtx->mPlay;
+        auto & batch = play.mBatch;
+        auto & frees = play.mFrees;
+
+        //  已离场的Actor, 内存延后释放, 后续轮次仍可读取标记
+        auto isGone = [] (const Actor * actor) { return actor->mIsDelete && !actor->mIsEnter; };
+
+        //  每轮换出已提交的命令, OnEnter与OnLeave中提交的进入下一轮, 直到不再有新命令
+        while (!play.mCommands.empty())
+        {
+            batch.swap(play.mCommands);
+
+            //  新增
+            for (auto & command : batch)
+            {
+                if (command.mKind == Kind::kAppendActor)
+                {
+                    auto actor = command.mActor;
+                    actor->mIsEnter = true;
+                    play.mActors.emplace(actor->mID, actor);
+                    for (auto comp : actor->mComps) { TickEnter(comp); comp->OnEnter(); }
+                    CullEnter(actor);
+                }
+                else if (command.mKind == Kind::kAppendComp)
+                {
+                    if (isGone(command.mActor))
+                    {
+                        frees.push_back(command);
+                        continue;
+                    }
+                    command.mActor->mComps.emplace_back(command.mComp);
+                    TickEnter(command.mComp);
+                    command.mComp->OnEnter();
+                    CullEnter(command.mActor);
+                }
+                else if ((command.mKind == Kind::kSleepComp || command.mKind == Kind::kWakeComp)
+                         && !command.mComp->mIsDelete && !command.mActor->mIsDelete)
+                {
+                    TickSleep(command.mComp, command.mKind == Kind::kSleepComp);
+                }
+            }
+
+            //  删除, 重复提交已在入队时过滤, 随Actor删除的组件由Actor处理
+            for (auto & command : batch)
+            {
+                if (command.mKind == Kind::kDeleteComp && !command.mActor->mIsDelete)
+                {
+                    auto & comps = command.mActor->mComps;
+                    comps.erase(std::find(comps.begin(), comps.end(), command.mComp));
+                    TickLeave(command.mComp);
+                    command.mComp->OnLeave();
+                    frees.push_back(command);
+                }
+            }
+            for (auto & command : batch)
+            {
+                if (command.mKind == Kind::kDeleteActor)
+                {
+                    play.mActors.erase(command.mActor->mID);
+                    CullLeave(command.mActor);
+                    for (auto comp : command.mActor->mComps) { TickLeave(comp); comp->OnLeave(); }
+                    command.mActor->mIsEnter = false;
+                    frees.push_back(command);
+                }
+            }
+            batch.clear();
+        }
+
+        for (auto & command : frees)
+        {
+            if (command.mKind == Kind::kDeleteActor) { delete command.mActor; }
+            else                                     { delete command.mComp;  }
+        }
+        frees.clear();
+
+        //  压缩更新列表, 保持顺序
+        if (play.mIsTickDirty)
+        {
+            auto end = std::remove(play.mTicks.begin(), play.mTicks.end(), nullptr);
+            play.mTicks.erase(end, play.mTicks.end());
+            for (size_t i = 0; i != play.mTicks.size(); ++i) { play.mTicks[i]->mTick = i; }
+            play.mIsTickDirty = false;
+        }
+    }
+
+    void UpdateCull()
+    {
+        auto & cull = mCtx->mPlay.mCull;
+        cull.mX.clear(); cull.mY.clear();
+        cull.mR.clear(); cull.mOut.clear();
+
+        //  收集, 无包围半径的Actor始终可见, 不参与
+        for (auto actor : cull.mTrack)
+        {
+            auto & coord = actor->mTrans->Coord();
+            cull.mX.push_back(coord.x);
+            cull.mY.push_back(coord.y);
+            cull.mR.push_back(actor->mBound * actor->mTrans->Scale());
+            cull.mOut.push_back(actor->mOutDelete);
+        }
+
+        //  测试
+        auto count = cull.mTrack.size();
+        cull.mVisible.resize(count);
+        cull.mDelete.resize(count);
+        const auto w = mCtx->mPlay.mRange.x;
+        const auto h = mCtx->mPlay.mRange.y;
+        for (size_t i = 0; i != count; ++i)
+        {
+            auto x = cull.mX[i], y = cull.mY[i];
+            auto r = cull.mR[i], o = cull.mOut[i];
+            cull.mVisible[i] = (r == 0) | ((x + r >= 0) & (y + r >= 0) & (x - r <= w) & (y - r <= h));
+            cull.mDelete[i]  = (o != 0) & ((x + o < 0) | (y + o < 0) | (x - o > w) | (y - o > h));
+        }
+
+        //  应用
+        for (size_t i = 0; i != count; ++i)
+        {
+            cull.mTrack[i]->mIsVisible = cull.mVisible[i] != 0;
+            if (cull.mDelete[i] != 0) { DeleteActor(cull.mTrack[i]); }
+        }
+    }
+
+    void UpdateAnimate()
+    {
+        auto now = mCtx->mLastTime;
+        for (auto sprite : mCtx->mPlay.mAnimates)
         {
-            mCtx.mPlay.mActors.emplace(actor->mID, actor);
-            std::for_each(actor->mComps.begin(), actor->mComps.end(),
-                std::bind(&Component::OnEnter, std::placeholders::_1));
+            auto clip  = sprite->mClip;
+            auto count = (uint)clip->mFrames.size();
+            auto index = (uint)((now - sprite->mStart) * clip->mInverse);
+            sprite->mCurr = clip->mIsLoop ? index % count
+                                          : std::min(index, count - 1);
         }
-        mCtx.mPlay.mAppends.clear();
+    }
 
-        //  删除
-        for (auto actor : mCtx.mPlay.mDeletes)
+    //  按深度顺序重算脏的世界变换, 父节点先于子节点, 静态子树只检查标记
+    void UpdateTransform()
+    {
+        auto & play = mCtx->mPlay;
+        auto & nodes = play.mHierarchy;
+        if (play.mIsHierarchyDirty)
         {
-            auto n = mCtx.mPlay.mActors.erase(actor->mID);
-            if (n != 0)
+            Memory::Scope scope(Memory::Tag::kActor);
+            nodes.erase(std::remove(nodes.begin(), nodes.end(), nullptr), nodes.end());
+            std::stable_sort(nodes.begin(), nodes.end(), [] (CompTransform * a, CompTransform * b)
+            {
+                return a->Depth() < b->Depth();
+            });
+            auto & flags = play.mHierarchyDirty;
+            flags.resize(nodes.size());
+            for (size_t i = 0; i != nodes.size(); ++i)
             {
-                std::for_each(actor->mComps.begin(), actor->mComps.end(),
-                    std::bind(&Component::OnLeave, std::placeholders::_1));
-                delete actor;
+                nodes[i]->Index(i);
+                flags[i] = nodes[i]->IsDirty();
             }
+            play.mIsHierarchyDirty = false;
         }
-        mCtx.mPlay.mDeletes.clear();
 
-        for (auto actor : mCtx.mPlay.mActors)
+        //  memchr跳过连续的干净段
+        auto flags = play.mHierarchyDirty.data();
+        auto end   = flags + nodes.size();
+        for (auto p = flags; (p = (uint8_t *)std::memchr(p, 1, end - p)) != nullptr; ++p)
         {
-            std::for_each(actor.second->mComps.begin(), actor.second->mComps.end(),
-                std::bind(&Component::OnUpdate, std::placeholders::_1, mCtx.mDiffTime));
+            nodes[p - flags]->Resolve();
         }
     }
 
+    void UpdateCollide()
+    {
+        Memory::Scope scope(Memory::Tag::kCollide);
+        auto & collide = mCtx->mPlay.mCollide;
+        collide.ForEach([] (Collide::Body * body)
+        {
+            auto comp = (CompCollision *)body->mUser;
+            body->mCoord = comp->mOwner->mTrans->Coord();
+            if (body->mShape != Collide::Shape::kCircle)
+            {
+                body->mAxis = Math::ToVec(comp->mOwner->mTrans->Angle());
+            }
+        });
+
+        auto & pairs = collide.Update();
+        mCtx->mStats.mFrame.mTested = (float)collide.mTested;
+        mCtx->mStats.mFrame.mHit    = (float)pairs.size();
+        for (auto & pair : pairs)
+        {
+            auto a = (CompCollision *)pair.mA->mUser;
+            auto b = (CompCollision *)pair.mB->mUser;
+            if (a->mOwner != b->mOwner)
+            {
+                a->OnHit(b);
+                b->OnHit(a);
+            }
+        }
+    }
+
+    void UpdateParticle()
+    {
+        Memory::Scope scope(Memory::Tag::kParticle);
+        mCtx->mPlay.mParticle.Update(mCtx->mDiffTime);
+        mCtx->mPlay.mParticle.Render(mCtx->mPlay.mRange, *mCtx->mDraw);
+    }
+
+    //  统计周期0.5秒
+    void UpdateStats()
+    {
+        auto & stats = mCtx->mStats;
+        auto & frame = stats.mFrame;
+        frame.mRender = stats.mRender.load(std::memory_order_relaxed);
+        stats.mHistory[stats.mHead++ % Stats::kHistory] = mCtx->mDiffTime * 1000;
+        stats.mSum.Add(frame, 1);
+        stats.mFrames += 1;
+        for (size_t i = 0; i != (size_t)Memory::Tag::kCount; ++i)
+        {
+            stats.mTagSum[i].mCount += stats.mTags[i].mCount;
+            stats.mTagSum[i].mBytes += stats.mTags[i].mBytes;
+            stats.mTagTotal[i].mCount += stats.mTags[i].mCount;
+            stats.mTagTotal[i].mBytes += stats.mTags[i].mBytes;
+        }
+
+        auto now = mCtx->mLastTime;
+        if (now - stats.mStart < 0.5f) { return; }
+
+        stats.mAverage = Stats::Frame();
+        stats.mAverage.Add(stats.mSum, 1.0f / stats.mFrames);
+        stats.mFPS = stats.mFrames / (now - stats.mStart);
+        stats.mVersion += 1;
+        for (size_t i = 0; i != (size_t)Memory::Tag::kCount; ++i)
+        {
+            stats.mTagAverage[i] = (float)stats.mTagSum[i].mCount / stats.mFrames;
+            stats.mTagSum[i] = { 0, 0 };
+        }
+        if (stats.mCSV.is_open())
+        {
+            auto & avg = stats.mAverage;
+            stats.mCSV << now << ',' << stats.mFPS << ',' << avg.mInput << ',' << avg.mUpdate << ','
+                       << avg.mCollide << ',' << avg.mTimer << ',' << avg.mSim << ',' << avg.mRender << ','
+                       << mCtx->mPlay.mActors.size() << ',' << avg.mTested << ',' << avg.mHit << ','
+                       << avg.mAllocs << ',' << avg.mBytes << ',' << Memory::Resident() << '\n';
+        }
+        stats.mSum = Stats::Frame();
+        stats.mFrames = 0;
+        stats.mStart = now;
+    }
+
     Contex * Ctx()
     {
-        return &mCtx;
+        return mCtx;
+    }
+
+    Contex * BindWorld(Contex * world)
+    {
+        auto last = mCtx;
+        mCtx = world;
+        Math::RandomEngine() = &world->mRandom;
+        Script::Pool::Current() = &world->mScriptPool;
+        return last;
     }
 
     Actor * AppendActor()
     {
+        Memory::Scope scope(Memory::Tag::kActor);
         auto actor = new Actor();
-        actor->mID = mCtx.mGID++;
+        actor->mID = mCtx->mGID++;
+        actor->mIsVisible = true;
+        actor->mCull = kNoIndex;
         actor->AddComponent<CompTransform>();
-        mCtx.mPlay.mAppends.emplace_back(actor);
+        mCtx->mPlay.mCommands.push_back({ GamePlay::Command::Kind::kAppendActor, actor, nullptr });
         return actor;
     }
 
     void DeleteActor(Actor * actor)
     {
-        mCtx.mPlay.mDeletes.emplace_back(actor);
+        if (!actor->mIsDelete)
+        {
+            actor->mIsDelete = true;
+            mCtx->mPlay.mCommands.push_back({ GamePlay::Command::Kind::kDeleteActor, actor, nullptr });
+        }
+    }
+
+    void CountComponent(const std::type_info & type, const Memory::Counter & delta)
+    {
+        auto & count = mCtx->mPlay.mCompMemory[type];
+        count.mCount += delta.mCount;
+        count.mBytes += delta.mBytes;
+    }
+
+    void AttachComponent(Actor * actor, Component * comp)
+    {
+        mCtx->mPlay.mCommands.push_back({ GamePlay::Command::Kind::kAppendComp, actor, comp });
+    }
+
+    void DeleteComponent(Component * comp)
+    {
+        if (!comp->mIsDelete)
+        {
+            comp->mIsDelete = true;
+            mCtx->mPlay.mCommands.push_back({ GamePlay::Command::Kind::kDeleteComp, comp->mOwner, comp });
+        }
+    }
+
+    void SleepComponent(Component * comp)
+    {
+        mCtx->mPlay.mCommands.push_back({ GamePlay::Command::Kind::kSleepComp, comp->mOwner, comp });
+    }
+
+    void WakeComponent(Component * comp)
+    {
+        mCtx->mPlay.mCommands.push_back({ GamePlay::Command::Kind::kWakeComp, comp->mOwner, comp });
+    }
+
+    void SetState(PlayState state)
+    {
+        auto & peak = mCtx->mStats.mPeaks[(uint)mCtx->mPlay.mState];
+        peak = std::max(peak, Memory::Peak());
+        Memory::ResetPeak();
+
+        mCtx->mPlay.mEvents.Publish(StateEvent{ state, mCtx->mPlay.mState });
+        mCtx->mPlay.mState = state;
+    }
+
+    const Clip * CreateClip(const std::string & name, const std::vector<std::string> & images,
+                            float interval, bool isLoop, const Vec2 & anchor)
+    {
+        Clip clip;
+        clip.mBound   = 0;
+        clip.mIsLoop  = isLoop;
+        clip.mInverse = 1.0f / interval;
+        for (auto & image : images)
+        {
+            auto w = 0, h = 0;
+            auto frame = mCtx->mImages.at(image);
+            Simple2D::GetImageSize(frame, &w, &h);
+            clip.mFrames.push_back({ frame, Vec2(w * anchor.x, h * anchor.y) });
+            clip.mBound = std::max(clip.mBound, Math::Length(Vec2((float)w, (float)h)));
+        }
+        return &(mCtx->mClips[name] = std::move(clip));
+    }
+
+    const Clip * FindClip(const std::string & name)
+    {
+        return &mCtx->mClips.at(name);
+    }
+
+    //  原型与AppendActor创建的Actor相同, 但不进入场景
+    Actor * CreatePrefab(const std::string & name)
+    {
+        Memory::Scope scope(Memory::Tag::kActor);
+        auto prefab = new Actor();
+        prefab->mIsVisible = true;
+        prefab->mCull = kNoIndex;
+        prefab->AddComponent<CompTransform>();
+        mCtx->mPrefabs.emplace(name, prefab);
+        return prefab;
+    }
+
+    const Actor * FindPrefab(const std::string & name)
+    {
+        return mCtx->mPrefabs.at(name);
+    }
+
+    //  复制原型的组件数据, 不再执行配置代码
+    Actor * Spawn(const Actor * prefab)
+    {
+        Memory::Scope scope(Memory::Tag::kActor);
+        auto actor = new Actor();
+        actor->mID        = mCtx->mGID++;
+        actor->mTag       = prefab->mTag;
+        actor->mIsVisible = true;
+        actor->mBound     = prefab->mBound;
+        actor->mOutDelete = prefab->mOutDelete;
+        actor->mCull      = kNoIndex;
+        actor->mComps.reserve(prefab->mComps.size());
+        for (auto comp : prefab->mComps)
+        {
+            Memory::Scope clone_scope(Memory::Tag::kComponent);
+            auto clone = comp->Clone();
+            assert(clone != nullptr);
+            CountComponent(comp->GetType(), clone_scope.Delta());
+            clone->mOwner    = actor;
+            clone->mIsDelete = false;
+            clone->mTick     = kNoIndex;
+            actor->mComps.push_back(clone);
+            if (comp == prefab->mTrans) { actor->mTrans = (CompTransform *)clone; }
+        }
+        mCtx->mPlay.mCommands.push_back({ GamePlay::Command::Kind::kAppendActor, actor, nullptr });
+        return actor;
+    }
+
+    void Spawn(const Actor * prefab, const Vec2 * coords, size_t count, Actor ** out)
+    {
+        mCtx->mPlay.mCommands.reserve(mCtx->mPlay.mCommands.size() + count);
+        for (size_t i = 0; i != count; ++i)
+        {
+            auto actor = Spawn(prefab);
+            actor->mTrans->Coord(coords[i]);
+            if (out != nullptr) { out[i] = actor; }
+        }
     }
 
     Actor * FindActor(uint id)
     {
-        auto it = mCtx.mPlay.mActors.find(id);
-        return it != mCtx.mPlay.mActors.end() ? it->second : nullptr;
+        auto it = mCtx->mPlay.mActors.find(id);
+        return it != mCtx->mPlay.mActors.end() ? it->second : nullptr;
     }
 
     Actor * FindActor(const std::string & tag)
     {
         auto fn = [&tag] (auto & v) { return v.second->mTag == tag; };
-        auto it = std::find_if(mCtx.mPlay.mActors.begin(), 
-                               mCtx.mPlay.mActors.end(), fn);
-        return it != mCtx.mPlay.mActors.end() ? it->second : nullptr;
+        auto it = std::find_if(mCtx->mPlay.mActors.begin(), 
+                               mCtx->mPlay.mActors.end(), fn);
+        return it != mCtx->mPlay.mActors.end() ? it->second : nullptr;
     }
 }
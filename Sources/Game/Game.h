@@ -1,12 +1,26 @@
 #pragma once
 
 #include <map>
+#include <atomic>
+#include <fstream>
 #include <vector>
 #include <string>
+#include <thread>
 #include <cassert>
 #include <typeinfo>
+#include <typeindex>
+#include <type_traits>
 #include "Math.h"
 #include "Timer.h"
+#include "Script.h"
+#include "Collide.h"
+#include "Particle.h"
+#include "Event.h"
+#include "Input.h"
+#include "Render.h"
+#include "Archive.h"
+#include "Scene.h"
+#include "Memory.h"
 #include "Simple2D.h"
 
 using uint = std::uint32_t;
@@ -21,7 +35,9 @@ namespace Game {
         kDirU = 0x4,
         kDirD = 0x8,
         kFire = 0x10,
+        kHud  = 0x20,
     };
+    static const uint kInputCount = 6;
 
     enum class PlayState {
         kMenu,      //  游戏菜单
@@ -33,6 +49,7 @@ namespace Game {
         kSuccess,   //  胜利
         kFailed,    //  失败
     };
+    static const uint kPlayStateCount = 8;
 
     enum class CollisionTag {
         kBullet = 0x1,
@@ -40,18 +57,55 @@ namespace Game {
         kEnemy  = 0x4,
     };
 
+    enum class EffectEnum {
+        kBoom,          //  爆炸
+    };
+
+    enum class CollisionLayer {
+        kPlayer,        //  玩家
+        kPlayerBullet,  //  玩家子弹
+        kEnemy,         //  敌人
+        kEnemyBullet,   //  敌人子弹
+    };
+
+    //  事件
+    struct StateEvent {
+        PlayState mState;
+        PlayState mLast;
+    };
+
+    struct DieEvent {
+        uint mActor;
+        Vec2 mCoord;
+    };
+
     struct Actor;
     struct Component;
+    struct CompSprite;
     struct CompTransform;
 
+    void AttachComponent(Actor * actor, Component * comp);
+    void CountComponent(const std::type_info & type, const Memory::Counter & delta);
+
+    static const size_t kNoIndex = SIZE_MAX;
+
     struct Component {
     public:
         Actor * mOwner;
+        bool    mIsDelete;  //  已提交删除
+        bool    mIsSleep;   //  休眠, 不参与更新
+        size_t  mTick;      //  在mTicks中的下标, 不在列表中为kNoIndex
         virtual ~Component() {}
         virtual void OnEnter() = 0;
         virtual void OnLeave() = 0;
         virtual void OnUpdate(float dt) = 0;
-        virtual const type_info & GetType() = 0;
+        virtual const std::type_info & GetType() = 0;
+
+        //  是否需要每帧OnUpdate
+        virtual bool IsTick() { return true; }
+
+        //  预制体实例化时复制, 用于预制体的组件需要实现
+        virtual Component * Clone() { return nullptr; }
 
         friend struct Actor;
     };
@@ -62,6 +116,12 @@ namespace Game {
         std::string mTag;
         CompTransform * mTrans;
         std::vector<Component *> mComps;
+        bool  mIsEnter;     //  已进入场景
+        bool  mIsDelete;    //  已提交删除
+        bool  mIsVisible;   //  视口内可见
+        float mBound;       //  包围半径, 0不剔除
+        float mOutDelete;   //  出界删除边距, 0不删除
+        size_t mCull;       //  在mCull.mTrack中的下标
 
         ~Actor()
         {
@@ -71,16 +131,28 @@ namespace Game {
             }
         }
 
+        //  已进入场景的Actor, 新组件在帧边界挂载并OnEnter
         template <typename T>
         T * AddComponent()
         {
-            auto comp = mComps.emplace_back(new T());
-            if (typeid(T) == typeid(CompTransform))
+            Memory::Scope scope(Memory::Tag::kComponent);
+            auto comp = new T();
+            CountComponent(typeid(T), scope.Delta());
+            comp->mOwner = this;
+            comp->mTick  = kNoIndex;
+            if constexpr (std::is_same_v<T, CompTransform>)
             {
-                mTrans = (CompTransform *)comp;
+                mTrans = comp;
             }
-            comp->mOwner = this;
-            return (T *)comp;
+            if (mIsEnter)
+            {
+                AttachComponent(this, comp);
+            }
+            else
+            {
+                mComps.emplace_back(comp);
+            }
+            return comp;
         }
 
         template <typename T>
@@ -93,37 +165,268 @@ namespace Game {
         }
     };
 
+    //  动画片段, 创建后只读共享
+    struct Clip {
+        struct Frame {
+            Simple2D::Image * mImage;
+            Vec2 mOffset;       //  锚点偏移
+        };
+        std::vector<Frame> mFrames;
+        float mInverse;         //  1 / 帧间隔
+        bool  mIsLoop;
+        float mBound;           //  包围半径
+    };
+
     struct GamePlay {
         Vec2        mRange;         //  舞台范围
         PlayState   mState;         //  Play状态
-        std::map<uint, Actor *> mActors;
-        std::vector<Actor *> mDeletes;
-        std::vector<Actor *> mAppends;
+        std::map<uint, Actor *, std::less<uint>,
+                 Memory::Allocator<std::pair<const uint, Actor *>, Memory::Tag::kActor>> mActors;
+
+        //  结构变更命令, 帧边界批量执行
+        struct Command {
+            enum class Kind {
+                kAppendActor,
+                kDeleteActor,
+                kAppendComp,
+                kDeleteComp,
+                kSleepComp,
+                kWakeComp,
+            };
+            Kind        mKind;
+            Actor *     mActor;
+            Component * mComp;
+        };
+        std::vector<Command, Memory::Allocator<Command, Memory::Tag::kActor>> mCommands;
+        std::vector<Command, Memory::Allocator<Command, Memory::Tag::kActor>> mBatch;     //  UpdateCommand正在处理的一轮
+        std::vector<Command, Memory::Allocator<Command, Memory::Tag::kActor>> mFrees;     //  本次UpdateCommand离场待释放
+        Collide mCollide;           //  碰撞世界
+        Particle mParticle;         //  粒子
+        std::vector<CompSprite *> mAnimates;    //  多帧精灵
+
+        //  有父节点的变换, 按深度排序, 父节点总在子节点之前
+        std::vector<CompTransform *> mHierarchy;
+        std::vector<uint8_t> mHierarchyDirty;   //  对应的脏标记, 连续扫描, 静态子树不触及节点
+        bool mIsHierarchyDirty;
+
+        //  主角与Boss, 进入场景时登记, 供外部观测
+        Component * mHero;
+        Component * mBoss;
+
+        //  更新列表, 按进入顺序, 移除时置空并在帧边界压缩
+        std::vector<Component *, Memory::Allocator<Component *, Memory::Tag::kActor>> mTicks;
+        bool mIsTickDirty;
+        struct TickCount {
+            uint mTick;     //  参与更新
+            uint mSleep;    //  休眠或不需要更新
+        };
+        std::map<std::type_index, TickCount> mTickCounts;
+        std::map<std::type_index, Memory::Counter> mCompMemory;     //  按组件类型累计分配
+        EventBus mEvents;           //  事件总线
+
+        //  剔除
+        struct CullList {
+            std::vector<Actor *> mTrack;    //  有包围半径或出界删除的Actor
+            std::vector<float> mX;
+            std::vector<float> mY;
+            std::vector<float> mR;
+            std::vector<float> mOut;
+            std::vector<uint8_t> mVisible;
+            std::vector<uint8_t> mDelete;
+        } mCull;
+    };
+
+    //  性能统计, 统计周期内取平均, 供HUD与CSV使用
+    struct Stats {
+        static const size_t kHistory = 120;
+
+        //  单帧各阶段耗时(ms)与计数
+        struct Frame {
+            float mInput;       //  加载, 输入与事件
+            float mUpdate;      //  Actor, 事件与粒子
+            float mCollide;
+            float mTimer;
+            float mSim;         //  模拟合计
+            float mRender;      //  渲染线程最近一帧
+            float mTested;      //  碰撞窄相检测对数
+            float mHit;         //  碰撞命中对数
+            float mAllocs;      //  模拟线程分配次数
+            float mBytes;       //  模拟线程分配字节
+
+            void Add(const Frame & v, float scale)
+            {
+                mInput  += v.mInput  * scale; mUpdate += v.mUpdate * scale;
+                mCollide += v.mCollide * scale; mTimer += v.mTimer * scale;
+                mSim    += v.mSim    * scale; mRender += v.mRender * scale;
+                mTested += v.mTested * scale; mHit    += v.mHit    * scale;
+                mAllocs += v.mAllocs * scale; mBytes += v.mBytes * scale;
+            }
+        };
+
+        Frame  mFrame;                  //  本帧
+        Frame  mAverage;                //  上个周期平均
+        float  mFPS;                    //  上个周期帧率
+        uint   mVersion;                //  mAverage更新次数
+        float  mHistory[kHistory];      //  帧间隔环形缓冲
+        size_t mHead;
+        std::atomic<float> mRender;     //  渲染线程写入
+
+        Memory::Counter mTags[(size_t)Memory::Tag::kCount];     //  本帧按子系统
+        Memory::Counter mTagSum[(size_t)Memory::Tag::kCount];   //  周期累计
+        Memory::Counter mTagTotal[(size_t)Memory::Tag::kCount]; //  模拟线程累计
+        float  mTagAverage[(size_t)Memory::Tag::kCount];        //  上个周期每帧平均次数
+        int64_t mPeaks[kPlayStateCount];                        //  各状态常驻峰值
+
+        Frame  mSum;
+        uint   mFrames;
+        float  mStart;
+        std::ofstream mCSV;             //  SHOOTER_CSV指定时输出
+    };
+
+    //  资源后台加载
+    struct Loading {
+        std::vector<const Archive::Entry *> mEntrys;
+        std::vector<Simple2D::Image *>      mImages;
+        std::vector<std::thread>            mThreads;
+        std::atomic<uint>                   mNext;
+        std::atomic<uint>                   mDone;
+        bool                                mIsReady;   //  全部就绪, 可进入战斗
+
+        ~Loading()
+        {
+            for (auto & thread : mThreads) { thread.join(); }
+        }
+    };
+
+    //  外部驱动: 每步一个动作, 返回奖励与结束标记
+    struct Agent {
+        uint  mAction;      //  上一步的动作, 按差异生成按键事件
+        int   mHeroHp;      //  上一步观测到的血量, 差值作奖励
+        int   mBossHp;
     };
 
+    struct StepResult {
+        float mReward;      //  本步对Boss造成的伤害减去主角受到的伤害
+        bool  mIsDone;      //  胜利或失败
+    };
+
+    //  观测向量布局, 坐标与速度按舞台范围归一化, 血量按满血归一化, 缺席的项为0
+    namespace Observe {
+        static const size_t kSegments = 20;     //  Boss节数, 头在前
+        static const size_t kBullets  = 8;      //  距主角最近的敌方子弹
+        static const int    kFullHp   = 100;
+
+        static const size_t kHero     = 0;                          //  x, y, hp
+        static const size_t kBoss     = kHero + 3;                  //  hp, 各节x, y
+        static const size_t kBullet   = kBoss + 1 + kSegments * 2;  //  有效, dx, dy, vx, vy
+        static const size_t kSize     = kBullet + kBullets * 5;
+    }
+
     struct Contex {
         uint      mGID;     //  生成唯一ID
         uint      mInput;   //  当前输入
+        uint      mPressed; //  本帧按下过的键, 含帧内按下又松开
+        float     mPressTime[kInputCount];      //  按键最近按下的时间
+        RingQueue<KeyEvent, 256> mInputs;       //  窗口线程写入
+        uint      mFrame;   //  帧序号
         Timer     mTimer;   //  定时器
+        float     mStep;    //  固定步长, 0时按真实时间推进
+        std::minstd_rand mRandom;   //  本世界的随机数, 推进时绑定到当前线程
+        Script::Pool mScriptPool;   //  协程帧池, 推进时绑定到当前线程
+        Script::Scheduler mScript;  //  协程脚本, 休眠挂在mTimer上
         float     mLastTime;    //  最后响应时间
         float     mDiffTime;    //  当前响应时差
         Simple2D::Font * mFont24;   //  字体24
         Simple2D::Font * mFont36;   //  字体26
         Simple2D::Font * mFont72;   //  字体72
         std::map<std::string, Simple2D::Image *> mImages;
+        std::map<std::string, Clip> mClips;
+        std::map<std::string, Actor *> mPrefabs;    //  预制体原型, 不进入场景
+        Archive   mArchive;         //  资源包
+        Scene     mLevel;           //  关卡, 主世界持有
+        const Scene * mScene;       //  当前关卡, 无头世界共享assets的关卡
+        Loading   mLoading;
+        FrameQueue mFrames;         //  绘制帧
+        DrawList * mDraw;           //  当前记录的帧
+        Stats     mStats;           //  性能统计
+        Agent     mAgent;           //  外部驱动状态
 
         GamePlay mPlay;
     };
 
+    //  当前线程绑定的世界
     Contex * Ctx();
+
+    //  切换当前线程的世界, 返回原来的世界
+    Contex * BindWorld(Contex * world);
+
+    //  碰撞层矩阵, WorldInit与测试共用
+    void     InitLayers(Collide & collide);
+
+    //  无头世界: 共享assets已加载完成的贴图, 字体和动画, 其余状态独立, 按固定步长推进
+    Contex * CreateWorld(const Contex & assets, uint seed, float step);
+    void     DestroyWorld(Contex * world);
+
+    //  worlds静态分给threads个线程, 每个各推进ticks帧, 返回时全部完成
+    void     StepWorlds(Contex * const * worlds, size_t count, uint ticks, uint threads);
+
+    //  批量推进: 世界i应用actions[i](InputEnum位掩码)推进ticks帧, 结束后停止推进
+    //  观测写入obs + i * Observe::kSize, 结果写入results[i], 缓冲由调用方持有, 推进中不分配
+    //  菜单中按下kFire开始战斗, 结束的世界由调用方DestroyWorld后重建
+    void     StepBatch(Contex * const * worlds, size_t count, const uint * actions, uint ticks,
+                       float * obs, StepResult * results, uint threads);
+
+    //  只写观测, 不推进
+    void     ObserveWorld(Contex * world, float * obs);
     Actor * AppendActor();
     void    DeleteActor(Actor * actor);
+    void    DeleteComponent(Component * comp);
+    void    SleepComponent(Component * comp);
+    void    WakeComponent(Component * comp);
+    void    SetState(PlayState state);
     Actor * FindActor(uint id);
     Actor * FindActor(const std::string & tag);
+    const Clip * CreateClip(const std::string & name, const std::vector<std::string> & images,
+                            float interval, bool isLoop, const Vec2 & anchor = Vec2());
+    const Clip * FindClip(const std::string & name);
+    Actor * CreatePrefab(const std::string & name);
+    const Actor * FindPrefab(const std::string & name);
+    Actor * Spawn(const Actor * prefab);
+    void    Spawn(const Actor * prefab, const Vec2 * coords, size_t count, Actor ** out);
 
+    //  脚本内使用: co_await Game::Wait(0.1f); co_await Game::Until([this] { return mHp < 50; });
+    inline Script::Sleep Wait(float time)
+    {
+        return Script::Sleep(Ctx()->mScript, time, Ctx()->mLastTime);
+    }
+
+    template <class Fn>
+    Script::Until<Fn> Until(Fn fn)
+    {
+        return Script::Until<Fn>(Ctx()->mScript, fn);
+    }
+
+    void UpdateLoad();
     void UpdateInput();
+    void UpdateEvent();
     void UpdateActor();
+    void UpdateCommand();
+    void UpdateCull();
+    void UpdateAnimate();
+    void UpdateTransform();
+    void UpdateCollide();
+    void UpdateParticle();
+    void UpdateStats();
+    void LoadAssets();
     void GameInit();
+    void WorldInit();
+    void WorldReady();
     void GameStep();
     void GameStart();
+
+    float InputTime(uint mask);
+    void SampleInput();
+    void RenderFrame(Simple2D::Window * window);
+    void SimulateStart();
+    void SimulateStop();
 }
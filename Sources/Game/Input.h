@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+//  按键事件, 时间为采样时所在世界的时钟: 实时世界为游戏时间, 固定步长的世界为模拟时间
+struct KeyEvent {
+    uint32_t mInput;    //  InputEnum
+    bool     mIsDown;
+    float    mTime;
+};
+
+//  单生产者单消费者无锁环形队列, N为2的幂
+template <typename T, size_t N>
+class RingQueue {
+public:
+    static_assert((N & (N - 1)) == 0, "N must be a power of two");
+
+    RingQueue() : mHead(0), mTail(0)
+    { }
+
+    //  生产者, 队列满时丢弃
+    bool Push(const T & item)
+    {
+        auto tail = mTail.load(std::memory_order_relaxed);
+        if (tail - mHead.load(std::memory_order_acquire) == N)
+        {
+            return false;
+        }
+        mItems[tail & (N - 1)] = item;
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //  消费者
+    bool Pop(T & item)
+    {
+        auto head = mHead.load(std::memory_order_relaxed);
+        if (head == mTail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        item = mItems[head & (N - 1)];
+        mHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T mItems[N];
+    alignas(64) std::atomic<size_t> mHead;
+    alignas(64) std::atomic<size_t> mTail;
+};
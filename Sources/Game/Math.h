@@ -135,17 +135,22 @@ namespace Math {
 		return Normal(b - a) * d + a;
 	}
 
+	//	Random engine, bound to the current world by Game::BindWorld, never shared between threads
+	inline std::minstd_rand *& RandomEngine()
+	{
+		static thread_local std::minstd_rand sLocal;
+		static thread_local std::minstd_rand * sEngine = &sLocal;
+		return sEngine;
+	}
+
 	inline float Random(float min, float max)
 	{
-		static std::minstd_rand mr;
-		return std::normal_distribution(min, max)(mr);
+		return std::normal_distribution(min, max)(*RandomEngine());
 	}
 
 	inline int Random(int min, int max)
 	{
-		static std::random_device r;
-		static std::minstd_rand mr(r());
-		return std::uniform_int_distribution<size_t>(min, max)(mr);
+		return std::uniform_int_distribution<size_t>(min, max)(*RandomEngine());
 	}
 
 	inline bool IsContains(const Cir & cir, const Vec2 & p)
@@ -158,6 +163,26 @@ namespace Math {
 		return LengthSqr(a.mO - b.mO) <= (a.mR + b.mR) * (a.mR + b.mR);
 	}
 
+	//  a and b move by va and vb, t returns the first contact time in [0, 1]
+	inline bool IsSweepContains(const Cir & a, const Vec2 & va, const Cir & b, const Vec2 & vb, float & t)
+	{
+		auto p = a.mO - b.mO;
+		auto d = va - vb;
+		auto r = a.mR + b.mR;
+		auto c = LengthSqr(p) - r * r;
+		if (c <= 0) { t = 0; return true; }
+
+		auto e = LengthSqr(d);
+		auto f = Dot(p, d);
+		if (e == 0 || f >= 0) { return false; }
+
+		auto disc = f * f - e * c;
+		if (disc < 0) { return false; }
+
+		t = (-f - std::sqrt(disc)) / e;
+		return t <= 1;
+	}
+
 	inline Vec2 Beizer(const Vec2 & a, const Vec2 & b, const Vec2 & c, float t)
 	{
 		return Lerp(Lerp(a, b, t), Lerp(b, c, t), t);
@@ -199,9 +224,16 @@ namespace Math {
 	inline float ToAngle(const Vec2 & vec)
 	{
 		auto r = std::atan2(vec.y, vec.x);
-		auto a = 180 / (float)std::_Pi *r;
+		auto a = 180 / 3.14159265f * r;
 		return vec.y < 0 ? 360 + a : a;
 	}
+
+	//  Inverse of ToAngle, degrees to unit vector
+	inline Vec2 ToVec(float angle)
+	{
+		auto r = 3.14159265f / 180 * angle;
+		return Vec2(std::cos(r), std::sin(r));
+	}
 };
 
 struct Beizer {
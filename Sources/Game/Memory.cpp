@@ -0,0 +1,148 @@
+#include "Memory.h"
+#include <new>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+
+namespace {
+    //  块头记录大小, 保持malloc的16字节对齐
+    const size_t kHeader = 16;
+
+    thread_local Memory::Tag     sTag = Memory::Tag::kNone;
+    thread_local Memory::Counter sTotal = { 0, 0 };
+    thread_local Memory::Counter sTags[(size_t)Memory::Tag::kCount + 1] = { };
+
+    std::atomic<int64_t> sResident(0);
+    std::atomic<int64_t> sPeak(0);
+}
+
+//  替换全局分配函数, 数组与nothrow版本也显式转发, 避免与未加块头的默认实现混用
+void * operator new(std::size_t size)
+{
+    //  禁止分配区域内需显式Scope
+    assert(sTag != Memory::Tag::kNoAlloc);
+
+    auto p = (char *)std::malloc(size + kHeader);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    *(size_t *)p = size;
+
+    sTotal.mCount += 1;
+    sTotal.mBytes += size;
+    sTags[(size_t)sTag].mCount += 1;
+    sTags[(size_t)sTag].mBytes += size;
+
+    auto resident = sResident.fetch_add((int64_t)size, std::memory_order_relaxed) + (int64_t)size;
+    auto peak = sPeak.load(std::memory_order_relaxed);
+    while (resident > peak && !sPeak.compare_exchange_weak(peak, resident, std::memory_order_relaxed))
+    { }
+    return p + kHeader;
+}
+
+void operator delete(void * p) noexcept
+{
+    if (p != nullptr)
+    {
+        auto block = (char *)p - kHeader;
+        sResident.fetch_sub((int64_t)*(size_t *)block, std::memory_order_relaxed);
+        std::free(block);
+    }
+}
+
+void operator delete(void * p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+void * operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    try { return operator new(size); } catch (...) { return nullptr; }
+}
+
+void * operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    try { return operator new(size); } catch (...) { return nullptr; }
+}
+
+void operator delete[](void * p) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[](void * p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete(void * p, const std::nothrow_t &) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[](void * p, const std::nothrow_t &) noexcept
+{
+    operator delete(p);
+}
+
+namespace Memory {
+    uint64_t AllocCount()
+    {
+        return sTotal.mCount;
+    }
+
+    Counter Total()
+    {
+        return sTotal;
+    }
+
+    Counter Total(Tag tag)
+    {
+        return sTags[(size_t)tag];
+    }
+
+    const char * TagName(Tag tag)
+    {
+        static const char * sNames[] = {
+            "none", "load", "input", "actor", "component", "collide",
+            "event", "particle", "timer", "render", "navigation", "script", "behavior", "noalloc",
+        };
+        return sNames[(size_t)tag];
+    }
+
+    int64_t Resident()
+    {
+        return sResident.load(std::memory_order_relaxed);
+    }
+
+    int64_t Peak()
+    {
+        return sPeak.load(std::memory_order_relaxed);
+    }
+
+    void ResetPeak()
+    {
+        sPeak.store(sResident.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    Scope::Scope(Tag tag) : mLast(sTag), mStart(sTotal)
+    {
+        sTag = tag;
+    }
+
+    Scope::~Scope()
+    {
+        sTag = mLast;
+    }
+
+    Counter Scope::Delta() const
+    {
+        return { sTotal.mCount - mStart.mCount, sTotal.mBytes - mStart.mBytes };
+    }
+}
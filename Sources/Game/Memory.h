@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+//  全局operator new计数, 次数与字节按线程, 按子系统标签分类
+//  常驻字节与峰值为全进程统计
+namespace Memory {
+    enum class Tag : uint8_t {
+        kNone,
+        kLoad,          //  资源加载
+        kInput,         //  输入
+        kActor,         //  Actor与结构变更命令
+        kComponent,     //  组件创建
+        kCollide,       //  碰撞
+        kEvent,         //  事件
+        kParticle,      //  粒子
+        kTimer,         //  定时器
+        kRender,        //  绘制列表
+        kNavigation,    //  寻路
+        kScript,        //  协程脚本
+        kBehavior,      //  状态机敌人
+        kCount,
+        kNoAlloc = kCount,  //  禁止分配区域, 调试版断言
+    };
+
+    struct Counter {
+        uint64_t mCount;
+        uint64_t mBytes;
+    };
+
+    //  当前线程累计分配次数
+    uint64_t AllocCount();
+
+    //  当前线程累计分配, 总计或按标签
+    Counter Total();
+    Counter Total(Tag tag);
+
+    const char * TagName(Tag tag);
+
+    //  常驻字节与峰值
+    int64_t Resident();
+    int64_t Peak();
+    void    ResetPeak();
+
+    //  区域内分配计入tag, 可嵌套
+    class Scope {
+    public:
+        Scope(Tag tag);
+        ~Scope();
+
+        //  进入区域以来的分配
+        Counter Delta() const;
+
+    private:
+        Tag     mLast;
+        Counter mStart;
+    };
+
+    //  容器分配器, 分配计入固定标签
+    template <typename T, Tag kTag>
+    struct Allocator {
+        using value_type = T;
+
+        template <typename U>
+        struct rebind { using other = Allocator<U, kTag>; };
+
+        Allocator() = default;
+
+        template <typename U>
+        Allocator(const Allocator<U, kTag> &)
+        { }
+
+        T * allocate(size_t n)
+        {
+            Scope scope(kTag);
+            return (T *)::operator new(n * sizeof(T));
+        }
+
+        void deallocate(T * p, size_t)
+        {
+            ::operator delete(p);
+        }
+
+        template <typename U>
+        bool operator == (const Allocator<U, kTag> &) const { return true; }
+
+        template <typename U>
+        bool operator != (const Allocator<U, kTag> &) const { return false; }
+    };
+
+    //  区域内未显式打标签的分配在调试版断言
+    class NoAlloc : public Scope {
+    public:
+        NoAlloc() : Scope(Tag::kNoAlloc)
+        { }
+    };
+}
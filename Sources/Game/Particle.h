@@ -0,0 +1,149 @@
+#pragma once
+
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <algorithm>
+#include "Math.h"
+#include "Render.h"
+#include "Simple2D.h"
+
+//  粒子系统, 每个发射器一个SoA粒子池
+class Particle {
+public:
+    //  发射器预设
+    struct Emitter {
+        std::vector<Simple2D::Image *> mFrames;
+        Vec2     mAnchor;       //  锚点
+        float    mInterval;     //  帧间隔
+        float    mLife;         //  生命
+        Vec2     mSpeed;        //  初速度
+        float    mSpread;       //  速度随机范围
+        uint32_t mCount;        //  单次发射数量
+    };
+
+    struct Pool {
+        Emitter mEmitter;
+        std::vector<Vec2>     mOffsets;     //  每帧锚点偏移
+        float                 mBound;       //  剔除边距
+        std::vector<float>    mX,  mY;      //  位置
+        std::vector<float>    mVX, mVY;     //  速度
+        std::vector<float>    mAge;         //  年龄
+        std::vector<uint32_t> mFrame;       //  当前帧
+
+        size_t Size() const { return mAge.size(); }
+    };
+
+    void SetEmitter(uint32_t id, const Emitter & emitter)
+    {
+        if (id >= mPools.size()) { mPools.resize(id + 1); }
+
+        auto & pool = mPools.at(id);
+        pool.mEmitter = emitter;
+        pool.mOffsets.clear();
+        pool.mBound = 0;
+        for (auto image : emitter.mFrames)
+        {
+            auto w = 0, h = 0;
+            Simple2D::GetImageSize(image, &w, &h);
+            pool.mOffsets.emplace_back((float)w * emitter.mAnchor.x,
+                                       (float)h * emitter.mAnchor.y);
+            pool.mBound = std::max(pool.mBound, Math::Length(Vec2((float)w, (float)h)));
+        }
+    }
+
+    void Emit(uint32_t id, const Vec2 & coord)
+    {
+        auto & pool = mPools.at(id);
+        auto & emitter = pool.mEmitter;
+        std::uniform_real_distribution<float> spread(-emitter.mSpread, emitter.mSpread);
+        for (uint32_t i = 0; i != emitter.mCount; ++i)
+        {
+            pool.mX.push_back(coord.x);
+            pool.mY.push_back(coord.y);
+            pool.mVX.push_back(emitter.mSpeed.x + (emitter.mSpread != 0 ? spread(mRandom) : 0));
+            pool.mVY.push_back(emitter.mSpeed.y + (emitter.mSpread != 0 ? spread(mRandom) : 0));
+            pool.mAge.push_back(0);
+            pool.mFrame.push_back(0);
+        }
+    }
+
+    void Update(float dt)
+    {
+        for (auto & pool : mPools)
+        {
+            auto n = pool.Size();
+            auto x = pool.mX.data(), vx = pool.mVX.data();
+            auto y = pool.mY.data(), vy = pool.mVY.data();
+            auto age = pool.mAge.data();
+            auto frame = pool.mFrame.data();
+            auto last = (float)(pool.mEmitter.mFrames.size() - 1);
+            auto inv  = 1.0f / pool.mEmitter.mInterval;
+
+            //  无分支循环, 交给编译器向量化
+            for (size_t i = 0; i != n; ++i) { x[i] += vx[i] * dt; }
+            for (size_t i = 0; i != n; ++i) { y[i] += vy[i] * dt; }
+            for (size_t i = 0; i != n; ++i) { age[i] += dt; }
+            for (size_t i = 0; i != n; ++i) { frame[i] = (uint32_t)std::min(age[i] * inv, last); }
+
+            //  回收
+            auto life = pool.mEmitter.mLife;
+            for (size_t i = 0; i != pool.Size();)
+            {
+                if (pool.mAge[i] < life) { ++i; continue; }
+                auto back = pool.Size() - 1;
+                pool.mX[i] = pool.mX[back]; pool.mVX[i] = pool.mVX[back];
+                pool.mY[i] = pool.mY[back]; pool.mVY[i] = pool.mVY[back];
+                pool.mAge[i] = pool.mAge[back]; pool.mFrame[i] = pool.mFrame[back];
+                pool.mX.pop_back(); pool.mVX.pop_back();
+                pool.mY.pop_back(); pool.mVY.pop_back();
+                pool.mAge.pop_back(); pool.mFrame.pop_back();
+            }
+        }
+    }
+
+    //  按贴图批量提交, 同一贴图的粒子连续绘制
+    //  剔除时一次遍历按帧分桶, 不随帧数重复扫描
+    void Render(const Vec2 & range, DrawList & list)
+    {
+        for (auto & pool : mPools)
+        {
+            auto & frames = pool.mEmitter.mFrames;
+            auto b = pool.mBound;
+            if (mBuckets.size() < frames.size()) { mBuckets.resize(frames.size()); }
+            for (auto & bucket : mBuckets) { bucket.clear(); }
+
+            for (size_t i = 0; i != pool.Size(); ++i)
+            {
+                auto & offset = pool.mOffsets[pool.mFrame[i]];
+                auto x = pool.mX[i] - offset.x;
+                auto y = pool.mY[i] - offset.y;
+                if (x + b < 0 || y + b < 0 || x - b > range.x || y - b > range.y) { continue; }
+                mBuckets[pool.mFrame[i]].push_back((uint32_t)i);
+            }
+
+            for (uint32_t f = 0; f != frames.size(); ++f)
+            {
+                auto image = frames[f];
+                auto & offset = pool.mOffsets[f];
+                for (auto i : mBuckets[f])
+                {
+                    list.Image(image, pool.mX[i] - offset.x, pool.mY[i] - offset.y, 0, 1);
+                }
+            }
+        }
+    }
+
+    size_t Count() const
+    {
+        size_t count = 0;
+        for (auto & pool : mPools) { count += pool.Size(); }
+        return count;
+    }
+
+    std::vector<Pool> mPools;
+    std::minstd_rand  mRandom;
+
+private:
+    std::vector<std::vector<uint32_t>> mBuckets;     //  绘制时每帧可见粒子的下标, 复用容量
+};
@@ -2,12 +2,15 @@
 
 #include "Game.h"
 #include "Component.h"
+#include "Flow.h"
+#include "Behavior.h"
 
 namespace Play {
     //  背景
     struct Background : public Game::Component {
     private:
         Game::CompScrollScreen * mScroll;
+        uint mListen;
 
     public:
         virtual void OnEnter() override
@@ -21,14 +24,19 @@ namespace Play {
                                        (float)Game::mWindowH));
             scroll->SetSpeed(Vec2(0, 0));
             mScroll = scroll;
+
+            mListen = Game::Ctx()->mPlay.mEvents.Subscribe<Game::StateEvent>(
+                [this] (const Game::StateEvent * events, size_t count) { OnState(events[count - 1].mState); });
         }
 
         virtual void OnLeave() override
-        { }
+        {
+            Game::Ctx()->mPlay.mEvents.Unsubscribe<Game::StateEvent>(mListen);
+        }
 
-        virtual void OnUpdate(float dt) override
+        void OnState(Game::PlayState state)
         {
-            switch (Game::Ctx()->mPlay.mState)
+            switch (state)
             {
             case Game::PlayState::kSuccess:
             case Game::PlayState::kFailed:
@@ -43,69 +51,23 @@ namespace Play {
             }
         }
 
-        virtual const type_info & GetType() override
-        {
-            return typeid(Background);
-        }
-    };
-
-    //  碰撞
-    struct Collision : public Game::Component {
-    private:
-        void OnHit(Component * comp)
-        {
-            if (comp->GetType() != typeid(Collision) || comp->mOwner == mOwner || mHitFn == nullptr)
-            {
-                return;
-            }
-
-            auto other = (Collision *)comp;
-            if ((other->mSelf & mMask) == 0)
-            {
-                auto a = Cir(       mOwner->mTrans->Coord(),        mRadius);
-                auto b = Cir(other->mOwner->mTrans->Coord(), other->mRadius);
-                if (Math::IsContains(a, b)) { mHitFn(other); }
-            }
-        }
-
-    public:
-        uint mSelf; //  自身
-        uint mMask; //  屏蔽
-        float mRadius;
-        std::function<void(Collision *)> mHitFn;
-
-        virtual void OnEnter() override
-        { }
-
-        virtual void OnLeave() override
+        virtual void OnUpdate(float dt) override
         { }
 
-        virtual void OnUpdate(float dt) override
+        virtual bool IsTick() override
         {
-            auto & coord = mOwner->mTrans->Coord();
-            if (coord.x + mRadius * 10 < 0 ||
-                coord.y + mRadius * 10 < 0 ||
-                coord.x - mRadius * 10 > Game::Ctx()->mPlay.mRange.x ||
-                coord.y - mRadius * 10 > Game::Ctx()->mPlay.mRange.y)
-            {
-                Game::DeleteActor(mOwner);
-            }
-            else
-            {
-                for (auto actor : Game::Ctx()->mPlay.mActors)
-                {
-                    std::for_each(actor.second->mComps.begin(), actor.second->mComps.end(),
-                        std::bind(&Collision::OnHit, this, std::placeholders::_1));
-                }
-            }
+            return false;
         }
 
-        virtual const type_info & GetType() override
+        virtual const std::type_info & GetType() override
         {
-            return typeid(Collision);
+            return typeid(Background);
         }
     };
 
+    //  碰撞
+    using Collision = Game::CompCollision;
+
     //  战斗中
 
     //  结束
@@ -135,86 +97,55 @@ namespace Play {
         virtual void OnUpdate(float dt) override
         { }
 
-        virtual const type_info & GetType() override
-        {
-            return typeid(GameOver);
-        }
-    };
-
-    //  爆炸
-    struct Boom : public Game::Component {
-        float mTime;
-        Vec2 mCoord;
-
-        virtual void OnEnter() override
-        {
-            mOwner->mTrans->Coord(mCoord);
-
-            auto sprite = mOwner->AddComponent<Game::CompSprite>();
-            sprite->mCurr = 0;
-            sprite->mIsLoop = false;
-            sprite->mInterval = 0.1f;
-            sprite->AddFrame(Game::Ctx()->mImages.at("Explosion_1"));
-            sprite->AddFrame(Game::Ctx()->mImages.at("Explosion_2"));
-
-            mTime = 0.2f;
-        }
-
-        virtual void OnLeave() override
-        { }
-
-        virtual void OnUpdate(float dt) override
+        virtual bool IsTick() override
         {
-            mTime = std::max(0.0f, mTime - dt);
-
-            auto coord = mOwner->mTrans->Coord();
-            coord.x -= dt * 500;
-            mOwner->mTrans->Coord(coord);
-
-            if (mTime == 0) { Game::DeleteActor(mOwner); }
+            return false;
         }
 
-        virtual const type_info & GetType() override
+        virtual const std::type_info & GetType() override
         {
             return typeid(GameOver);
         }
     };
 
-    //  子弹
+    //  子弹, 由预制体复制生成, 生成后设置坐标和速度
     struct Bullet : public Game::Component {
         bool mIsDie;
-        float mRadius;          //  半径
         Vec2 mSpeed;            //  速度
-        Vec2 mCoord;            //  初始坐标
-        uint mSelf;             //  自身碰撞Tag
-        uint mMask;             //  屏蔽碰撞Tag
-        std::string mImage;     //  自身贴图
+
+        //  子弹是沿速度方向的胶囊, length为两端圆心间的半长
+        static void CreatePrefab(const std::string & name, float radius, float length, uint self, uint mask,
+                                 Game::CollisionLayer layer, bool isFast)
+        {
+            auto prefab = Game::CreatePrefab(name);
+            prefab->mOutDelete = (radius + length) * 8;
+            prefab->AddComponent<Bullet>();
+
+            auto collision = prefab->AddComponent<Collision>();
+            collision->mRadius = radius;
+            collision->mShape  = Collide::Shape::kCapsule;
+            collision->mHalf   = Vec2(length, 0);
+            collision->mSelf = self;
+            collision->mMask = mask;
+            collision->mIsFast = isFast;
+            collision->mLayer = layer;
+
+            auto sprite = prefab->AddComponent<Game::CompSprite>();
+            sprite->SetClip(Game::FindClip(name));
+        }
 
         virtual void OnEnter() override
         {
             mIsDie = false;
-
-            mOwner->mTrans->Coord(mCoord);
-
-            auto collision = mOwner->AddComponent<Collision>();
-            collision->mRadius = mRadius;
-            collision->mSelf = mSelf;
-            collision->mMask = mMask;
-            collision->mHitFn = std::bind(&Bullet::OnHit, this, std::placeholders::_1);
-
-            auto sprite = mOwner->AddComponent<Game::CompSprite>();
-            sprite->mIsLoop = false; sprite->mInterval = 1.0f;
-            sprite->mAnchor = Vec2(0.0f, 0.0f); sprite->mCurr = 0;
-            sprite->AddFrame(Game::Ctx()->mImages.at(mImage));
+            mOwner->mTrans->Angle(Math::ToAngle(mSpeed));
+            mOwner->GetComponent<Collision>()->mHitFn = std::bind(&Bullet::OnHit, this, std::placeholders::_1);
         }
 
         void OnHit(Collision * comp)
         {
             if (!mIsDie)
             {
-                auto actor = Game::AppendActor();
-                auto boom = actor->AddComponent<Boom>();
-                boom->mCoord = mOwner->mTrans->Coord();
+                Game::Ctx()->mPlay.mEvents.Publish(Game::DieEvent{ mOwner->mID, mOwner->mTrans->Coord() });
                 mIsDie = true;
             }
             
@@ -237,7 +168,12 @@ namespace Play {
             }
         }
 
-        virtual const type_info & GetType() override
+        virtual Component * Clone() override
+        {
+            return new Bullet(*this);
+        }
+
+        virtual const std::type_info & GetType() override
         {
             return typeid(Bullet);
         }
@@ -250,12 +186,16 @@ namespace Play {
             Game::Actor * mActor;
         };
         std::vector<Item> mItems;
-        Beizer mPaths[3];
+        std::vector<Beizer> mPaths;
         size_t mIndex;
         float mMoveTime;
-        float mFireTime;
+        float mFireCD;
         size_t mFireIdx;
         int mHp;
+        const Game::Actor * mBullet;
+        const Scene::Setting * mSetting;
+        Script::Task mFire;
+        Script::Task mRage;
 
         bool UpdateCoord(float dt)
         {
@@ -265,20 +205,20 @@ namespace Play {
 
             mMoveTime = std::min(1.0f, mMoveTime + dt *0.0001f);
             coord = mPaths[mIndex].Calc(mMoveTime);
-            for (auto i = 0; i != mItems.size(); ++i)
+
+            //  头挂在Boss上随之移动, 身体是拖尾链, 逐节写世界坐标
+            mOwner->mTrans->Coord(coord);
+            for (auto i = 1; i != mItems.size(); ++i)
             {
                 auto & item = mItems.at(i);
-                if (i != 0)
-                {
-                    item.mCoord.x += item.mSpeed.x;
-                    item.mCoord.y += item.mSpeed.y;
-                    auto & a = mItems.at(i - 1);
-                    auto & b = mItems.at(i    );
-                    b.mCoord = Math::LimitLength(a.mCoord, b.mCoord, 50);
-
-                    auto angle = Math::ToAngle(item.mCoord - preCoord);
-                    item.mActor->mTrans->Angle(angle);
-                }
+                item.mCoord.x += item.mSpeed.x;
+                item.mCoord.y += item.mSpeed.y;
+                auto & a = mItems.at(i - 1);
+                auto & b = mItems.at(i    );
+                b.mCoord = Math::LimitLength(a.mCoord, b.mCoord, 50);
+
+                auto angle = Math::ToAngle(item.mCoord - preCoord);
+                item.mActor->mTrans->Angle(angle);
                 item.mActor->mTrans->Coord(item.mCoord);
 
                 item.mSpeed.x *= 0.8f;
@@ -292,59 +232,59 @@ namespace Play {
             auto first  = mItems.empty();
             auto & item = mItems.emplace_back();
 
-            auto actor = Game::AppendActor();
-
-            actor->mTrans->Coord(Vec2((float)Game::mWindowW, (float)Game::mWindowH));
-
-            auto sprite = actor->AddComponent<Game::CompSprite>();
-            sprite->mInterval = 1; sprite->mIsLoop = false; sprite->mCurr = 0;
-            sprite->AddFrame(Game::Ctx()->mImages.at(first ? "Enemy_3" : "Enemy_1"));
-
-            auto collision = actor->AddComponent<Collision>();
-            collision->mHitFn = std::bind(&Boss::OnHit, this,
+            auto actor = Game::Spawn(Game::FindPrefab(first ? "BossHead" : "BossBody"));
+            if (first)
+            {
+                mOwner->mTrans->Coord(Vec2((float)Game::mWindowW, (float)Game::mWindowH));
+                actor->mTrans->Parent(mOwner->mTrans);
+            }
+            else
+            {
+                actor->mTrans->Coord(Vec2((float)Game::mWindowW, (float)Game::mWindowH));
+            }
+            actor->GetComponent<Collision>()->mHitFn = std::bind(&Boss::OnHit, this,
                     std::placeholders::_1, mItems.size() - 1);
-            collision->mSelf = (int)Game::CollisionTag::kEnemy;
-            collision->mMask = (int)Game::CollisionTag::kEnemy;
-            collision->mRadius = first ? 50.0f : 20.0f;
 
             item.mActor = actor;
         }
 
         virtual void OnEnter() override
         {
-            mPaths[0].InitBeizer({
-                { Game::mWindowW * 0.7f, Game::mWindowH * 0.5f },
-                { Game::mWindowW * 0.1f, Game::mWindowH * 0.9f },
-                { Game::mWindowW * 0.1f, Game::mWindowH * 0.1f },
-                { Game::mWindowW * 0.9f, Game::mWindowH * 0.1f },
-                { Game::mWindowW * 0.9f, Game::mWindowH * 0.9f },
-                { Game::mWindowW * 0.7f, Game::mWindowH * 0.5f },
-            });
+            //  路径与数值来自关卡
+            auto & scene = *Game::Ctx()->mScene;
+            mPaths.resize(scene.mPaths.Size());
+            for (size_t i = 0; i != mPaths.size(); ++i)
+            {
+                auto points = &scene.mPoints[scene.mPaths[i].mFirst];
+                mPaths[i].InitBeizer(std::vector<Vec2>(points, points + scene.mPaths[i].mCount));
+            }
+            mSetting = &scene.Settings();
 
-            mPaths[1].InitBeizer({
-                { Game::mWindowW * 0.7f, Game::mWindowH * 0.5f },
-                { Game::mWindowW * 0.1f, Game::mWindowH * 0.1f },
-                { Game::mWindowW * 0.1f, Game::mWindowH * 0.9f },
-                { Game::mWindowW * 0.5f, Game::mWindowH * 0.1f },
-                { Game::mWindowW * 0.9f, Game::mWindowH * 0.9f },
-                { Game::mWindowW * 0.9f, Game::mWindowH * 0.1f },
-                { Game::mWindowW * 0.7f, Game::mWindowH * 0.5f },
-            });
+            mHp = mSetting->mBossHp;
+            mBullet = Game::FindPrefab("EnemyBullet");
+            mIndex = std::min<size_t>(1, mPaths.size() - 1);
+            mMoveTime = 0.0f;
+            mFireCD = mSetting->mFireCD;
+            mFire = FireLoop();
+            mRage = RageLoop();
+            Game::Ctx()->mPlay.mBoss = this;
+        }
 
-            mPaths[2].InitBeizer({
-                { Game::mWindowW * 0.7f, Game::mWindowH * 0.5f },
-                { Game::mWindowW * 0.1f, Game::mWindowH * 0.1f },
-                { Game::mWindowW * 0.1f, Game::mWindowH * 0.9f },
-                { Game::mWindowW * 0.9f, Game::mWindowH * 0.1f },
-                { Game::mWindowW * 0.9f, Game::mWindowH * 0.9f },
-                { Game::mWindowW * 0.6f, Game::mWindowH * 0.5f },
-                { Game::mWindowW * 0.7f, Game::mWindowH * 0.5f },
-            });
+        //  开火节奏挂在定时器上, 休眠期间不占用Update
+        Script::Task FireLoop()
+        {
+            for (;;)
+            {
+                Fire();
+                co_await Game::Wait(mFireCD);
+            }
+        }
 
-            mHp = 100;
-            mIndex = 1;
-            mMoveTime = 0.0f;
-            mFireTime = 0.0f;
+        //  血量低于狂暴线后加快开火
+        Script::Task RageLoop()
+        {
+            co_await Game::Until([this] { return mHp < mSetting->mRageHp; });
+            mFireCD = mSetting->mRageCD;
         }
 
         void OnHit(Collision * comp, size_t index)
@@ -357,17 +297,14 @@ namespace Play {
 
             if (--mHp == 0)
             {
-                Game::Ctx()->mPlay.mState = Game::PlayState::kSuccess;
+                Game::SetState(Game::PlayState::kSuccess);
 
                 auto actor = Game::AppendActor();
                 actor->AddComponent<GameOver>();
 
                 for (auto & item : mItems)
                 {
-                    auto actor  = Game::AppendActor();
-                    auto boom   = actor->AddComponent<Boom>();
-                    boom->mCoord = item.mActor->mTrans->Coord();
-
+                    Game::Ctx()->mPlay.mEvents.Publish(Game::DieEvent{ item.mActor->mID, item.mActor->mTrans->Coord() });
                     Game::DeleteActor(item.mActor);
                 }
                 Game::DeleteActor(mOwner);
@@ -379,38 +316,41 @@ namespace Play {
             mFireIdx = (mFireIdx + 1) % mItems.size();
 
             auto &item = mItems.at(mFireIdx);
-            auto actor = Game::AppendActor();
-            auto bullet = actor->AddComponent<Bullet>();
-            bullet->mCoord = item.mActor->mTrans->Coord();
-            bullet->mImage = "EnemyBullet";
-            bullet->mMask = (int)Game::CollisionTag::kEnemy;
-            bullet->mSelf = (int)Game::CollisionTag::kEnemy
-                            | (int)Game::CollisionTag::kBullet;
-            bullet->mRadius = 25;
+            auto actor = Game::Spawn(mBullet);
+            actor->mTrans->Coord(item.mActor->mTrans->Coord());
 
+            auto bullet = actor->GetComponent<Bullet>();
             bullet->mSpeed.x = Math::Random(-1.0f, 2.0f);
             bullet->mSpeed.y = Math::Random(-1.0f, 2.0f);
+
+            //  每4发有1发瞄准最近的玩家
+            Collide::Hit hit;
+            auto & coord = actor->mTrans->Coord();
+            auto layer = 1u << (uint)Game::CollisionLayer::kPlayer;
+            if (mFireIdx % 4 == 0 && Game::Ctx()->mPlay.mCollide.Nearest(coord, layer, &hit, 1) != 0)
+            {
+                bullet->mSpeed = Math::Normal(hit.mBody->mCoord - coord) + bullet->mSpeed * 0.2f;
+            }
             bullet->mSpeed = Math::Normal(bullet->mSpeed) * 500;
         }
 
         virtual void OnLeave() override
-        { }
+        {
+            Game::Ctx()->mPlay.mBoss = nullptr;
+        }
 
         virtual void OnUpdate(float dt) override
         {
             if (UpdateCoord(dt))
             {
-                mIndex = Math::Random(0, 2);
+                mIndex = Math::Random(0, (int)mPaths.size() - 1);
                 mMoveTime = 0;
             }
-            auto a = mItems.front().mActor->mTrans->Angle();
-            mItems.front().mActor->mTrans->Angle(a + 10.0f);
-
-            mFireTime = std::max(0.0f, mFireTime - dt);
-            if (mFireTime == 0) { Fire(); mFireTime = 0.1f; }
+            auto head = mItems.front().mActor->mTrans;
+            head->Angle(head->LocalAngle() + 10.0f);
         }
 
-        virtual const type_info & GetType() override
+        virtual const std::type_info & GetType() override
         {
             return typeid(Boss);
         }
@@ -424,61 +364,68 @@ namespace Play {
         float   mRadius;
         Vec2    mSpeed;
         int     mHp;
+        const Game::Actor * mBullet;
 
         virtual void OnEnter() override
         {
+            mBullet = Game::FindPrefab("PlayerBullet");
             mFireCD = 0.1f;
             mRadius = 50;
             mSpeed.x = 0;
             mSpeed.y = 0;
             mHp = 100;
 
-            mOwner->mTrans->Coord(Vec2(Game::mWindowW * 0.3f,
-                                       Game::mWindowH * 0.5f));
+            mOwner->mTrans->Coord(Game::Ctx()->mScene->Settings().mHero);
 
             auto collision = mOwner->AddComponent<Collision>();
             collision->mRadius = mRadius;
             collision->mSelf = (int)Game::CollisionTag::kPlayer;
             collision->mMask = (int)Game::CollisionTag::kPlayer;
+            collision->mLayer = Game::CollisionLayer::kPlayer;
             collision->mHitFn  = std::bind(&Hero::OnHit, this, std::placeholders::_1);
 
             auto sprite = mOwner->AddComponent<Game::CompSprite>();
-            sprite->mIsLoop = false; sprite->mInterval = 1.0f;
-            sprite->mAnchor = Vec2(0.0f, 0.0f); sprite->mCurr = 0;
-            sprite->AddFrame(Game::Ctx()->mImages.at("Player_3"));
+            sprite->SetClip(Game::FindClip("Player_3"));
+            Game::Ctx()->mPlay.mHero = this;
         }
 
         void OnHit(Collision * comp)
         {
-            mHp = comp->mSelf == (int)Game::CollisionTag::kEnemy
-                                      ? 0: std::max(0, mHp - 1);
+            Damage(comp->mSelf == (int)Game::CollisionTag::kEnemy ? mHp : 1);
+        }
+
+        void Damage(int count)
+        {
+            if (mHp == 0) { return; }
+
+            mHp = std::max(0, mHp - count);
 
             if (mHp == 0)
             {
-                Game::Ctx()->mPlay.mState = Game::PlayState::kFailed;
+                Game::SetState(Game::PlayState::kFailed);
 
                 {
                     auto actor = Game::AppendActor();
                     actor->AddComponent<GameOver>();
                 }
 
-                {
-                    auto actor = Game::AppendActor();
-                    auto boom  = actor->AddComponent<Boom>();
-                    boom->mCoord = mOwner->mTrans->Coord();
-                }
+                Game::Ctx()->mPlay.mEvents.Publish(Game::DieEvent{ mOwner->mID, mOwner->mTrans->Coord() });
 
                 Game::DeleteActor(mOwner);
             }
         }
 
         virtual void OnLeave() override
-        { }
+        {
+            Game::Ctx()->mPlay.mHero = nullptr;
+        }
 
         virtual void OnUpdate(float dt) override
         {
+            auto now  = Game::Ctx()->mLastTime;
             auto keys = (int)Game::InputEnum::kDirU | (int)Game::InputEnum::kDirD
                       | (int)Game::InputEnum::kDirL | (int)Game::InputEnum::kDirR;
+            auto step = dt;
             if ((Game::Ctx()->mInput & keys) != 0)
             {
                 mSpeed.x = 0; mSpeed.y = 0;
@@ -487,44 +434,489 @@ namespace Play {
                 if      ((Game::Ctx()->mInput & (int)Game::InputEnum::kDirU) != 0) { mSpeed.y =  1; }
                 else if ((Game::Ctx()->mInput & (int)Game::InputEnum::kDirD) != 0) { mSpeed.y = -1; }
                 mSpeed = Math::Normal(mSpeed) * 1000;
+
+                //  从实际按下时刻开始移动
+                step = std::min(dt, now - Game::InputTime(keys));
             }
 
             auto coord = mOwner->mTrans->Coord();
             coord = Math::LimitCoord(Game::Ctx()->mPlay.mRange,
-                            Cir(coord + mSpeed * dt, mRadius));
+                            Cir(coord + mSpeed * step, mRadius));
             mOwner->mTrans->Coord(coord);
 
-            if ((Game::Ctx()->mInput & (int)Game::InputEnum::kFire) != 0)
+            //  开火节奏按实际按下时刻排定, 帧内短按也会开火
+            auto fire = (int)Game::InputEnum::kFire;
+            if (((Game::Ctx()->mInput | Game::Ctx()->mPressed) & fire) != 0)
             {
-                if (Simple2D::GetGameTime() - mFireTM > mFireCD)
+                auto time = std::max(mFireTM + mFireCD, Game::InputTime(fire));
+                for (; time <= now; time += mFireCD)
                 {
-                    auto actor = Game::AppendActor();
+                    auto actor = Game::Spawn(mBullet);
+                    auto bullet = actor->GetComponent<Bullet>();
+                    bullet->mSpeed = Vec2(2000, 0);
+                    actor->mTrans->Coord(coord + bullet->mSpeed * (now - time));
 
-                    auto comp = actor->AddComponent<Bullet>();
-                    comp->mCoord = coord;
-                    comp->mImage = "PlayerBullet";
-                    comp->mSelf = (int)Game::CollisionTag::kPlayer
-                                | (int)Game::CollisionTag::kBullet;
-                    comp->mMask = (int)Game::CollisionTag::kPlayer;
-                    comp->mSpeed = Vec2(2000, 0);
-                    comp->mRadius = 30;
-
-                    mFireTM = Simple2D::GetGameTime();
+                    mFireTM = time;
                 }
             }
 
             mSpeed = mSpeed * 0.5f;
         }
 
-        virtual const type_info & GetType() override
+        virtual const std::type_info & GetType() override
         {
             return typeid(Hero);
         }
     };
 
 
+    //  敌群, 沿流场追踪最近的玩家, 分波次出现
+    struct Swarm : public Game::Component {
+    private:
+        static constexpr float kScale = 0.6f;
+
+        Flow mFlow;
+        Flow::Agents mAgents;
+        std::vector<size_t> mDead;
+        Simple2D::Image * mImage;
+        float mRadius;
+        uint  mWave;
+        Script::Task mWaves;
+
+    public:
+        virtual void OnEnter() override
+        {
+            mFlow.Init(Game::Ctx()->mPlay.mRange, 40);
+            mImage = Game::Ctx()->mImages.at("Enemy_2");
+
+            auto w = 0, h = 0;
+            Simple2D::GetImageSize(mImage, &w, &h);
+            mRadius = std::min(w, h) * 0.3f * kScale;
+            mWave = 0;
+            mWaves = WaveLoop();
+        }
+
+        //  按关卡波次表出现, 最后一波之后按重复间隔再来
+        Script::Task WaveLoop()
+        {
+            auto scene = Game::Ctx()->mScene;
+            auto time  = 0.0f;
+            for (auto & wave : scene->mWaves)
+            {
+                co_await Game::Wait(wave.mTime - time);
+                time = wave.mTime;
+                SpawnWave(wave.mCount);
+            }
+            auto repeat = scene->Settings().mRepeat;
+            if (repeat <= 0 || scene->mWaves.Size() == 0) { co_return; }
+            for (auto count = scene->mWaves[scene->mWaves.Size() - 1].mCount;;)
+            {
+                co_await Game::Wait(repeat);
+                SpawnWave(count);
+            }
+        }
+
+        virtual void OnLeave() override
+        { }
+
+        void SpawnWave(uint count)
+        {
+            Memory::Scope scope(Memory::Tag::kNavigation);
+            auto & range = Game::Ctx()->mPlay.mRange;
+            ++mWave;
+            for (uint i = 0; i != count; ++i)
+            {
+                mAgents.Append(Vec2(range.x - Math::Random(0.0f, 50.0f), Math::Random(0.0f, range.y)));
+            }
+        }
+
+        //  敌群不进碰撞世界, 由玩家子弹和玩家按格查询
+        void UpdateHit(Collide::Body * body)
+        {
+            Cir cir(body->mCoord, Collide::Bound(body) + mRadius);
+            mFlow.ForEach(cir, [&] (uint32_t i)
+            {
+                if (Collide::Distance(body, Vec2(mAgents.mX[i], mAgents.mY[i])) > mRadius) { return true; }
+
+                //  关卡预制体可以放在玩家或玩家子弹层而不带Hero/Bullet组件, 不参与命中
+                auto comp = (Collision *)body->mUser;
+                if (body->mLayer == (uint)Game::CollisionLayer::kPlayer)
+                {
+                    auto hero = comp->mOwner->GetComponent<Hero>();
+                    if (hero == nullptr) { return false; }
+                    hero->Damage(1);
+                }
+                else
+                {
+                    auto bullet = comp->mOwner->GetComponent<Bullet>();
+                    if (bullet == nullptr || bullet->mIsDie) { return false; }
+                    bullet->OnHit(nullptr);
+                }
+                mDead.push_back(i);
+                return body->mLayer == (uint)Game::CollisionLayer::kPlayer;
+            });
+        }
+
+        virtual void OnUpdate(float dt) override
+        {
+            Memory::Scope scope(Memory::Tag::kNavigation);
+            auto & collide = Game::Ctx()->mPlay.mCollide;
+            Collide::Hit hit;
+            if (collide.Nearest(mOwner->mTrans->Coord(), 1u << (uint)Game::CollisionLayer::kPlayer, &hit, 1) != 0)
+            {
+                mFlow.Update(hit.mBody->mCoord);
+            }
+            mFlow.Steer(mAgents, 150, 10, 4, dt);
+
+            mDead.clear();
+            for (auto body : collide.mLayers[(uint)Game::CollisionLayer::kPlayerBullet])
+            {
+                UpdateHit(body);
+            }
+            for (auto body : collide.mLayers[(uint)Game::CollisionLayer::kPlayer])
+            {
+                UpdateHit(body);
+            }
+
+            //  从后往前删除, 避免交换搬走待删代理
+            std::sort(mDead.begin(), mDead.end(), std::greater<size_t>());
+            mDead.erase(std::unique(mDead.begin(), mDead.end()), mDead.end());
+            for (auto i : mDead)
+            {
+                Game::Ctx()->mPlay.mEvents.Publish(Game::DieEvent{ mOwner->mID, Vec2(mAgents.mX[i], mAgents.mY[i]) });
+                mAgents.Remove(i);
+            }
+
+            auto & list = *Game::Ctx()->mDraw;
+            for (size_t i = 0; i != mAgents.Size(); ++i)
+            {
+                list.Image(mImage, mAgents.mX[i], mAgents.mY[i],
+                           Math::ToAngle(Vec2(mAgents.mVX[i], mAgents.mVY[i])), kScale);
+            }
+        }
+
+        virtual const std::type_info & GetType() override
+        {
+            return typeid(Swarm);
+        }
+    };
+
+    //  状态机敌人, 按关卡的批次出现, 行为由关卡的状态表驱动, 逐状态成批推进
+    //  与敌群相同不进碰撞世界, 由玩家子弹和玩家逐个查询
+    struct Horde : public Game::Component {
+    private:
+        static constexpr float kBulletSpeed = 300;
+        static constexpr float kMargin      = 100;     //  离开舞台多远后删除
+
+        Behavior mBehavior;
+        Behavior::Agents mAgents;
+        std::vector<Behavior::Shot> mShots;
+        std::vector<Simple2D::Image *> mImages;     //  按类型
+        std::vector<size_t> mDead;
+        const Scene * mScene;
+        const Game::Actor * mBullet;
+        Script::Task mSquads;
+
+    public:
+        virtual void OnEnter() override
+        {
+            mScene = Game::Ctx()->mScene;
+            mBehavior.Init(mScene->mStates.mData, mScene->mStates.Size(), mScene->mTrans.mData);
+            for (auto & machine : mScene->mMachines)
+            {
+                mImages.push_back(Game::Ctx()->mImages.at(machine.mImage));
+            }
+            mBullet = Game::FindPrefab("EnemyBullet");
+            mSquads = SquadLoop();
+        }
+
+        Script::Task SquadLoop()
+        {
+            auto time = 0.0f;
+            for (auto & squad : mScene->mSquads)
+            {
+                co_await Game::Wait(squad.mTime - time);
+                time = squad.mTime;
+                SpawnSquad(squad);
+            }
+        }
+
+        virtual void OnLeave() override
+        { }
+
+        //  矩形内均匀分布, 初始朝向舞台中心
+        void SpawnSquad(const Scene::Squad & squad)
+        {
+            Memory::Scope scope(Memory::Tag::kBehavior);
+            auto & machine = mScene->mMachines[squad.mMachine];
+            auto center = Game::Ctx()->mPlay.mRange * 0.5f;
+            std::uniform_real_distribution<float> rx(squad.mMin.x, squad.mMax.x);
+            std::uniform_real_distribution<float> ry(squad.mMin.y, squad.mMax.y);
+            for (uint i = 0; i != squad.mCount; ++i)
+            {
+                auto coord = Vec2(rx(*Math::RandomEngine()), ry(*Math::RandomEngine()));
+                mAgents.Append(coord, Math::ToAngle(center - coord), machine.mRadius, machine.mHp,
+                               machine.mState, squad.mMachine);
+                mBehavior.Enter(mAgents, mAgents.Size() - 1, machine.mState);
+            }
+        }
+
+        //  先按外接圆筛选, 再按形状精确判断
+        void UpdateHit(Collide::Body * body)
+        {
+            auto comp  = (Collision *)body->mUser;
+            auto bound = Collide::Bound(body);
+            auto x = mAgents.mX.data(), y = mAgents.mY.data(), radius = mAgents.mRadius.data();
+            auto hp = mAgents.mHp.data();
+            for (size_t i = 0; i != mAgents.Size(); ++i)
+            {
+                auto dx = x[i] - body->mCoord.x, dy = y[i] - body->mCoord.y, r = bound + radius[i];
+                if (dx * dx + dy * dy > r * r || hp[i] <= 0) { continue; }
+                if (Collide::Distance(body, Vec2(x[i], y[i])) > radius[i]) { continue; }
+
+                //  关卡预制体可以放在玩家或玩家子弹层而不带Hero/Bullet组件, 不参与命中
+                if (body->mLayer == (uint)Game::CollisionLayer::kPlayer)
+                {
+                    auto hero = comp->mOwner->GetComponent<Hero>();
+                    if (hero == nullptr) { return; }
+                    hero->Damage(1);
+                    hp[i] = 0;
+                }
+                else
+                {
+                    auto bullet = comp->mOwner->GetComponent<Bullet>();
+                    if (bullet == nullptr || bullet->mIsDie) { return; }
+                    bullet->OnHit(nullptr);
+                    --hp[i];
+                }
+                if (hp[i] <= 0) { mDead.push_back(i); }
+                if (body->mLayer != (uint)Game::CollisionLayer::kPlayer) { return; }
+            }
+        }
+
+        virtual void OnUpdate(float dt) override
+        {
+            Memory::Scope scope(Memory::Tag::kBehavior);
+            auto & play  = Game::Ctx()->mPlay;
+            auto & range = play.mRange;
+            Collide::Hit hit;
+            auto target = range * 0.5f;
+            if (play.mCollide.Nearest(target, 1u << (uint)Game::CollisionLayer::kPlayer, &hit, 1) != 0)
+            {
+                target = hit.mBody->mCoord;
+            }
+
+            mShots.clear();
+            mBehavior.Update(mAgents, target, dt, mShots);
+            for (auto & shot : mShots)
+            {
+                auto actor = Game::Spawn(mBullet);
+                actor->mTrans->Coord(shot.mCoord);
+                actor->GetComponent<Bullet>()->mSpeed = shot.mDir * kBulletSpeed;
+            }
+
+            mDead.clear();
+            for (auto body : play.mCollide.mLayers[(uint)Game::CollisionLayer::kPlayerBullet])
+            {
+                UpdateHit(body);
+            }
+            for (auto body : play.mCollide.mLayers[(uint)Game::CollisionLayer::kPlayer])
+            {
+                UpdateHit(body);
+            }
+            for (size_t i = 0; i != mAgents.Size(); ++i)
+            {
+                if (mAgents.mX[i] < -kMargin || mAgents.mX[i] > range.x + kMargin ||
+                    mAgents.mY[i] < -kMargin || mAgents.mY[i] > range.y + kMargin)
+                {
+                    mDead.push_back(i);
+                }
+            }
+
+            //  从后往前删除, 被击毁的爆炸, 离场的直接移除
+            std::sort(mDead.begin(), mDead.end(), std::greater<size_t>());
+            mDead.erase(std::unique(mDead.begin(), mDead.end()), mDead.end());
+            for (auto i : mDead)
+            {
+                if (mAgents.mHp[i] <= 0)
+                {
+                    play.mEvents.Publish(Game::DieEvent{ mOwner->mID, Vec2(mAgents.mX[i], mAgents.mY[i]) });
+                }
+                mAgents.Remove(i);
+            }
+
+            auto & list = *Game::Ctx()->mDraw;
+            for (size_t i = 0; i != mAgents.Size(); ++i)
+            {
+                list.Image(mImages[mAgents.mKind[i]], mAgents.mX[i], mAgents.mY[i],
+                           Math::ToAngle(Vec2(mAgents.mDX[i], mAgents.mDY[i])), 1);
+            }
+        }
+
+        virtual const std::type_info & GetType() override
+        {
+            return typeid(Horde);
+        }
+    };
+
+    //  性能HUD, H键切换, 隐藏时自身与文字组件休眠
+    struct Hud : public Game::Component {
+    private:
+        static const size_t kLines = 8;
+
+        Game::CompText * mLines[kLines];
+        std::string mBar;
+        uint mListen;
+        uint mVersion;
+        bool mIsShow;
+
+        //  typeid名去掉命名空间, 兼容GCC与MSVC
+        static std::string TypeName(const char * name)
+        {
+            std::string result;
+            if (name[0] == 'N')
+            {
+                for (auto p = name + 1; *p >= '0' && *p <= '9';)
+                {
+                    auto length = std::strtoul(p, (char **)&p, 10);
+                    result.assign(p, length);
+                    p += length;
+                }
+                return result;
+            }
+            while (*name >= '0' && *name <= '9') { ++name; }
+            result = name;
+            auto pos = result.find_last_of(": ");
+            return pos != std::string::npos ? result.substr(pos + 1) : result;
+        }
+
+        void Show(bool isShow)
+        {
+            mIsShow = isShow;
+            for (auto line : mLines)
+            {
+                isShow ? Game::WakeComponent(line) : Game::SleepComponent(line);
+            }
+            isShow ? Game::WakeComponent(this) : Game::SleepComponent(this);
+            mVersion = Game::Ctx()->mStats.mVersion - 1;
+        }
+
+        void Refresh()
+        {
+            Memory::Scope scope(Memory::Tag::kRender);
+            auto & stats = Game::Ctx()->mStats;
+            auto & avg = stats.mAverage;
+            char text[128];
+            std::snprintf(text, sizeof(text), "FPS %.1f  sim %.2f ms  render %.2f ms",
+                          stats.mFPS, avg.mSim, avg.mRender);
+            mLines[0]->Text() = text;
+            std::snprintf(text, sizeof(text), "input %.3f  update %.3f  collide %.3f  timer %.3f ms",
+                          avg.mInput, avg.mUpdate, avg.mCollide, avg.mTimer);
+            mLines[1]->Text() = text;
+            std::snprintf(text, sizeof(text), "pairs %.0f tested %.0f hit  actors %zu",
+                          avg.mTested, avg.mHit, Game::Ctx()->mPlay.mActors.size());
+            mLines[2]->Text() = text;
+            std::snprintf(text, sizeof(text), "allocs %.1f / frame  %.0f B / frame  resident %lld KB  peak %lld KB",
+                          avg.mAllocs, avg.mBytes, (long long)Memory::Resident() / 1024, (long long)Memory::Peak() / 1024);
+            mLines[3]->Text() = text;
+
+            //  按子系统的每帧分配次数
+            mLines[4]->Text().clear();
+            for (size_t i = 0; i != (size_t)Memory::Tag::kCount; ++i)
+            {
+                if (stats.mTagAverage[i] == 0) { continue; }
+                std::snprintf(text, sizeof(text), "%s %.1f  ", Memory::TagName((Memory::Tag)i), stats.mTagAverage[i]);
+                mLines[4]->Text() += text;
+            }
+
+            //  按组件类型的存活数
+            size_t i = 0;
+            mLines[5]->Text().clear();
+            mLines[6]->Text().clear();
+            mLines[7]->Text().clear();
+            for (auto & pair : Game::Ctx()->mPlay.mTickCounts)
+            {
+                auto count = pair.second.mTick + pair.second.mSleep;
+                if (count == 0) { continue; }
+                std::snprintf(text, sizeof(text), "%s %u  ", TypeName(pair.first.name()).c_str(), count);
+                mLines[5 + std::min<size_t>(i++ / 5, 2)]->Text() += text;
+            }
+        }
+
+    public:
+        virtual void OnEnter() override
+        {
+            for (size_t i = 0; i != kLines; ++i)
+            {
+                auto actor = Game::AppendActor();
+                actor->mTrans->Coord(Vec2(Game::mWindowW * 0.5f, Game::mWindowH - 20.0f - i * 24.0f));
+
+                auto text = actor->AddComponent<Game::CompText>();
+                text->Font() = Game::Ctx()->mFont24;
+                text->mIsSleep = true;
+                mLines[i] = text;
+            }
+            mBar = "|";
+            mVersion = 0;
+            mIsShow = false;
+            Game::SleepComponent(this);
+
+            mListen = Game::Ctx()->mPlay.mEvents.Subscribe<KeyEvent>(
+                [this] (const KeyEvent * events, size_t count) { OnKey(events, count); });
+        }
+
+        virtual void OnLeave() override
+        {
+            Game::Ctx()->mPlay.mEvents.Unsubscribe<KeyEvent>(mListen);
+            for (auto line : mLines)
+            {
+                Game::DeleteActor(line->mOwner);
+            }
+        }
+
+        void OnKey(const KeyEvent * events, size_t count)
+        {
+            for (size_t i = 0; i != count; ++i)
+            {
+                if (events[i].mIsDown && events[i].mInput == (uint)Game::InputEnum::kHud)
+                {
+                    Show(!mIsShow);
+                }
+            }
+        }
+
+        //  文字每个统计周期刷新一次, 帧间隔曲线每帧绘制, 16.7ms对应24像素
+        virtual void OnUpdate(float dt) override
+        {
+            auto & stats = Game::Ctx()->mStats;
+            if (mVersion != stats.mVersion)
+            {
+                mVersion = stats.mVersion;
+                Refresh();
+            }
+
+            auto & list = *Game::Ctx()->mDraw;
+            auto font = Game::Ctx()->mFont24;
+            auto base = Game::mWindowH - 20.0f - kLines * 24.0f - 80.0f;
+            for (size_t i = 0; i != Game::Stats::kHistory; ++i)
+            {
+                auto ms = stats.mHistory[(stats.mHead + i) % Game::Stats::kHistory];
+                auto scale = std::min(std::max(ms / 16.7f, 0.1f), 3.0f);
+                list.Text(font, mBar, 160.0f + i * 4.0f, base + 12.0f * scale, 0, scale);
+            }
+        }
+
+        virtual const std::type_info & GetType() override
+        {
+            return typeid(Hud);
+        }
+    };
+
     //  游戏菜单
     struct Menu : public Game::Component {
+    private:
+        uint mListen;
+
     public:
         virtual void OnEnter() override
         {
@@ -534,37 +926,121 @@ namespace Play {
             auto text = mOwner->AddComponent<Game::CompText>();
             text->Font() = Game::Ctx()->mFont72;
             text->Text() = "Input Space Start!";
+
+            mListen = Game::Ctx()->mPlay.mEvents.Subscribe<KeyEvent>(
+                [this] (const KeyEvent * events, size_t count) { OnKey(events, count); });
         }
 
         virtual void OnLeave() override
-        { }
+        {
+            Game::Ctx()->mPlay.mEvents.Unsubscribe<KeyEvent>(mListen);
+        }
 
-        virtual void OnUpdate(float dt) override
+        void OnKey(const KeyEvent * events, size_t count)
         {
-            if ((Game::Ctx()->mInput & (int)Game::InputEnum::kFire) != 0)
+            //  战斗资源后台加载完成且关卡可用后才能开始
+            auto fn = [] (const KeyEvent & event) { return event.mIsDown && event.mInput == (uint)Game::InputEnum::kFire; };
+            if (mOwner->mIsDelete || !Game::Ctx()->mLoading.mIsReady || Game::Ctx()->mScene == nullptr
+                || std::none_of(events, events + count, fn))
             {
-                Game::Ctx()->mPlay.mState = Game::PlayState::kInit;
-                Game::DeleteActor(mOwner);
+                return;
+            }
 
-                {
-                    auto actor = Game::AppendActor();
-                    actor->AddComponent<Hero>();
-                }
+            Game::SetState(Game::PlayState::kInit);
+            Game::DeleteActor(mOwner);
+            StartLevel(*Game::Ctx()->mScene);
+        }
+
+        static void StartLevel(const Scene & scene)
+        {
+            {
+                auto actor = Game::AppendActor();
+                actor->AddComponent<Hero>();
+            }
+
+            {
+                auto actor = Game::AppendActor();
+                actor->AddComponent<Swarm>();
+            }
 
+            if (scene.mSquads.Size() != 0)
+            {
+                auto actor = Game::AppendActor();
+                actor->AddComponent<Horde>();
+            }
+
+            {
+                auto actor = Game::AppendActor();
+                auto boss = actor->AddComponent<Boss>();
+                for (uint i = 0; i != scene.Settings().mBossItems; ++i)
                 {
-                    auto actor = Game::AppendActor();
-                    auto boss = actor->AddComponent<Boss>();
-                    for (auto i = 0; i != 20; ++i)
-                    {
-                        boss->AppendItem();
-                    }
+                    boss->AppendItem();
                 }
             }
+
+            //  关卡Actor按段批量生成, 坐标直接取自映射的表
+            for (auto & run : scene.mRuns)
+            {
+                Game::Spawn(Game::FindPrefab(scene.mPrefabs[run.mPrefab].mName),
+                            &scene.mCoords[run.mFirst], run.mCount, nullptr);
+            }
         }
 
-        virtual const type_info & GetType() override
+        virtual void OnUpdate(float dt) override
+        { }
+
+        virtual bool IsTick() override
+        {
+            return false;
+        }
+
+        virtual const std::type_info & GetType() override
         {
             return typeid(Menu);
         }
     };
+
+    //  关卡声明的预制体: 精灵加可选碰撞, 碰撞标记由碰撞层决定
+    inline void CreatePrefabs(const Scene & scene)
+    {
+        for (auto & record : scene.mPrefabs)
+        {
+            auto prefab = Game::CreatePrefab(record.mName);
+
+            auto sprite = prefab->AddComponent<Game::CompSprite>();
+            sprite->SetClip(Game::FindClip(record.mClip));
+
+            if (record.mLayer == Scene::kNoLayer) { continue; }
+            auto layer    = (Game::CollisionLayer)record.mLayer;
+            auto isPlayer = layer == Game::CollisionLayer::kPlayer || layer == Game::CollisionLayer::kPlayerBullet;
+            auto isBullet = layer == Game::CollisionLayer::kPlayerBullet || layer == Game::CollisionLayer::kEnemyBullet;
+            auto side     = (int)(isPlayer ? Game::CollisionTag::kPlayer : Game::CollisionTag::kEnemy);
+
+            auto collision = prefab->AddComponent<Collision>();
+            collision->mSelf   = side | (isBullet ? (int)Game::CollisionTag::kBullet : 0);
+            collision->mMask   = side;
+            collision->mLayer  = layer;
+            collision->mRadius = record.mRadius;
+            collision->mShape  = (Collide::Shape)record.mShape;
+            collision->mHalf   = record.mHalf;
+        }
+    }
+
+    //  预制体, 战斗资源加载完成后创建一次
+    inline void CreatePrefabs()
+    {
+        //  贴图76x15
+        Bullet::CreatePrefab("PlayerBullet", 7.5f, 30.5f,
+                (int)Game::CollisionTag::kPlayer | (int)Game::CollisionTag::kBullet,
+                (int)Game::CollisionTag::kPlayer, Game::CollisionLayer::kPlayerBullet, true);
+        Bullet::CreatePrefab("EnemyBullet", 7.5f, 30.5f,
+                (int)Game::CollisionTag::kEnemy | (int)Game::CollisionTag::kBullet,
+                (int)Game::CollisionTag::kEnemy, Game::CollisionLayer::kEnemyBullet, false);
+
+        //  Boss头与身体节点由关卡声明, 命中回调生成后绑定
+        if (Game::Ctx()->mScene != nullptr)
+        {
+            CreatePrefabs(*Game::Ctx()->mScene);
+        }
+    }
 }
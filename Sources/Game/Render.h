@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "Memory.h"
+#include "Simple2D.h"
+
+//  一帧的绘制命令, 模拟线程写入, 发布后只读
+struct DrawList {
+    struct Command {
+        Simple2D::Image * mImage;   //  图片, 为空时绘制文字
+        Simple2D::Font  * mFont;
+        uint32_t mText;             //  文字在mChars中的偏移
+        uint32_t mSize;             //  文字长度
+        float mX, mY;
+        float mAngle;
+        float mScale;
+    };
+
+    std::vector<Command, Memory::Allocator<Command, Memory::Tag::kRender>> mCommands;
+    std::vector<char,    Memory::Allocator<char,    Memory::Tag::kRender>> mChars;
+    uint32_t mFrame;                //  帧序号
+    float mSimTime;                 //  模拟耗时(ms)
+    uint32_t mInputCount;           //  本帧处理的输入事件
+    float mInputLatency;            //  输入到模拟的延迟之和(ms)
+    float mInputMaxLatency;
+
+    DrawList()
+    {
+        Clear();
+    }
+
+    void Clear()
+    {
+        mCommands.clear();
+        mChars.clear();
+        mFrame = 0;
+        mSimTime = 0;
+        mInputCount = 0;
+        mInputLatency = 0;
+        mInputMaxLatency = 0;
+    }
+
+    void Image(Simple2D::Image * image, float x, float y, float angle, float scale)
+    {
+        mCommands.push_back({ image, nullptr, 0, 0, x, y, angle, scale });
+    }
+
+    void Text(Simple2D::Font * font, const std::string & text, float x, float y, float angle, float scale)
+    {
+        mCommands.push_back({ nullptr, font, (uint32_t)mChars.size(), (uint32_t)text.size(), x, y, angle, scale });
+        mChars.insert(mChars.end(), text.begin(), text.end());
+    }
+
+    //  在渲染线程回放
+    void Submit(std::string & buffer) const
+    {
+        for (auto & command : mCommands)
+        {
+            if (command.mImage != nullptr)
+            {
+                Simple2D::DrawImage(command.mImage, command.mX, command.mY, command.mAngle, command.mScale);
+            }
+            else
+            {
+                buffer.assign(mChars.data() + command.mText, command.mSize);
+                Simple2D::DrawString(command.mFont, buffer, command.mX, command.mY, command.mAngle, command.mScale);
+            }
+        }
+    }
+};
+
+//  无锁三缓冲: 模拟线程写Back, 渲染线程读Front, Ready在两者间交换
+class FrameQueue {
+public:
+    FrameQueue() : mReady(2), mBack(0), mFront(1)
+    { }
+
+    DrawList & Back()
+    {
+        return mLists[mBack];
+    }
+
+    //  模拟线程: 发布Back, 换回一个空闲缓冲
+    void Publish()
+    {
+        mBack = mReady.exchange(mBack | kFresh) & kIndex;
+    }
+
+    //  渲染线程: 有新帧则换入, 否则继续使用上一帧
+    const DrawList & Acquire()
+    {
+        if ((mReady.load() & kFresh) != 0)
+        {
+            mFront = mReady.exchange(mFront) & kIndex;
+        }
+        return mLists[mFront];
+    }
+
+    //  上次发布的帧已被渲染线程取走
+    bool IsConsumed() const
+    {
+        return (mReady.load() & kFresh) == 0;
+    }
+
+private:
+    static const uint32_t kFresh = 0x4;
+    static const uint32_t kIndex = 0x3;
+
+    DrawList mLists[3];
+    std::atomic<uint32_t> mReady;
+    uint32_t mBack;
+    uint32_t mFront;
+};
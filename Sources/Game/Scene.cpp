@@ -0,0 +1,412 @@
+#include "Scene.h"
+#include "Collide.h"
+#include <map>
+#include <cstring>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+
+namespace {
+    //  与Game::CollisionLayer顺序一致
+    const char * sLayers[] = { "player", "player_bullet", "enemy", "enemy_bullet" };
+
+    template <typename T>
+    Archive::Item MakeTable(const char * name, const std::vector<T> & records)
+    {
+        Archive::Item item;
+        std::memset(&item.mEntry, 0, sizeof(item.mEntry));
+        std::strcpy(item.mEntry.mName, name);
+        item.mEntry.mKind   = Archive::Kind::kTable;
+        item.mEntry.mWidth  = sizeof(T);
+        item.mEntry.mHeight = (uint32_t)records.size();
+        item.mData.resize(records.size() * sizeof(T));
+        if (!records.empty()) { std::memcpy(item.mData.data(), records.data(), item.mData.size()); }
+        return item;
+    }
+
+    template <typename T>
+    bool BindTable(const Archive & archive, const char * name, Scene::Table<T> & table)
+    {
+        table.mData = archive.Table<T>(name, table.mCount);
+        return table.mData != nullptr;
+    }
+
+    bool IsName(const char * name, size_t size)
+    {
+        return std::memchr(name, 0, size) != nullptr;
+    }
+}
+
+bool Scene::Open(const std::string & path)
+{
+    mBuffer.clear();
+    return mArchive.Open(path) && Bind();
+}
+
+bool Scene::Load(const std::string & path, std::string & error)
+{
+    std::ifstream ifile(path);
+    if (!ifile)
+    {
+        error = path + ": cannot open"; return false;
+    }
+    std::stringstream text;
+    text << ifile.rdbuf();
+
+    if (!Compile(text.str(), mBuffer, error)) { return false; }
+    if (!mArchive.Open(mBuffer.data(), mBuffer.size()) || !Bind())
+    {
+        error = path + ": invalid scene"; return false;
+    }
+    return true;
+}
+
+bool Scene::Bind()
+{
+    mSetting = nullptr;
+    uint32_t count = 0;
+    auto setting = mArchive.Table<Setting>("setting", count);
+    auto valid = setting != nullptr && count == 1
+              && BindTable(mArchive, "prefab", mPrefabs) && BindTable(mArchive, "run",   mRuns)
+              && BindTable(mArchive, "coord",  mCoords)  && BindTable(mArchive, "path",  mPaths)
+              && BindTable(mArchive, "point",  mPoints)  && BindTable(mArchive, "wave",  mWaves)
+              && BindTable(mArchive, "machine", mMachines) && BindTable(mArchive, "state", mStates)
+              && BindTable(mArchive, "trans",   mTrans)    && BindTable(mArchive, "squad", mSquads);
+
+    //  下标越界的文件整体拒绝, 之后按数组访问不再检查
+    for (uint32_t i = 0; valid && i != mPrefabs.Size(); ++i)
+    {
+        auto & prefab = mPrefabs[i];
+        valid = IsName(prefab.mName, sizeof(prefab.mName)) && IsName(prefab.mClip, sizeof(prefab.mClip))
+             && prefab.mShape <= (uint32_t)Collide::Shape::kBox
+             && (prefab.mLayer == kNoLayer || prefab.mLayer < std::size(sLayers));
+    }
+    for (uint32_t i = 0; valid && i != mRuns.Size(); ++i)
+    {
+        auto & run = mRuns[i];
+        valid = run.mPrefab < mPrefabs.Size() && (uint64_t)run.mFirst + run.mCount <= mCoords.Size();
+    }
+    for (uint32_t i = 0; valid && i != mPaths.Size(); ++i)
+    {
+        auto & path = mPaths[i];
+        valid = path.mCount >= 2 && (uint64_t)path.mFirst + path.mCount <= mPoints.Size();
+    }
+    for (uint32_t i = 0; valid && i != mMachines.Size(); ++i)
+    {
+        auto & machine = mMachines[i];
+        valid = IsName(machine.mName, sizeof(machine.mName)) && IsName(machine.mImage, sizeof(machine.mImage))
+             && machine.mState < mStates.Size();
+    }
+    for (uint32_t i = 0; valid && i != mStates.Size(); ++i)
+    {
+        auto & state = mStates[i];
+        valid = state.mMove < Behavior::Move::kCount && (uint64_t)state.mFirst + state.mCount <= mTrans.Size();
+    }
+    for (uint32_t i = 0; valid && i != mTrans.Size(); ++i)
+    {
+        valid = mTrans[i].mTo < mStates.Size() && mTrans[i].mCond < Behavior::Cond::kCount;
+    }
+    for (uint32_t i = 0; valid && i != mSquads.Size(); ++i)
+    {
+        valid = mSquads[i].mMachine < mMachines.Size();
+    }
+    valid = valid && mPaths.Size() != 0 && setting->mBossItems != 0;
+
+    if (!valid)
+    {
+        mArchive.Close();
+        return false;
+    }
+    mSetting = setting;
+    return true;
+}
+
+//  每行一条指令, #之后为注释:
+//  hero <x> <y>
+//  boss <节数> <血量> <开火间隔> <狂暴血量> <狂暴开火间隔>
+//  path <x> <y> <x> <y> ...            Boss路径, 每次随机选一条
+//  wave <时刻> <数量>                   敌群波次
+//  repeat <间隔>                        最后一波之后按间隔重复
+//  prefab <名字> <动画> [<碰撞层> circle <半径> | capsule <半径> <半长> | box <半宽> <半高> [圆角]]
+//  actor <预制体> <x> <y>
+//  grid <预制体> <x0> <y0> <x1> <y1> <列> <行>    编译时展开为逐个actor
+//  machine <名字> <贴图> <血量> <半径>                       状态机敌人, 首个状态为初始状态
+//  state <机> <状态> <hold|chase|flee|orbit|drift> <速度> <参数> <旋转> <开火间隔> <aim|ahead>
+//  on <机> <状态> <目标状态> <after|near|far|hurt> <值>      同一状态的转移按书写顺序判断
+//  squad <机> <时刻> <数量> <x0> <y0> <x1> <y1>
+bool Scene::Compile(const std::string & text, std::vector<uint8_t> & out, std::string & error)
+{
+    Setting setting;
+    setting.mHero      = Vec2(0, 0);
+    setting.mBossItems = 0;
+    setting.mBossHp    = 0;
+    setting.mFireCD    = 0;
+    setting.mRageHp    = 0;
+    setting.mRageCD    = 0;
+    setting.mRepeat    = 0;
+
+    std::vector<Prefab> prefabs;
+    std::map<std::string, uint32_t> names;
+    std::vector<std::pair<uint32_t, Vec2>> actors;
+    std::vector<Path> paths;
+    std::vector<Vec2> points;
+    std::vector<Wave> waves;
+    std::vector<Machine> machines;
+    std::map<std::string, uint32_t> machineNames;
+    std::map<std::string, uint32_t> stateNames;     //  "机.状态"
+    std::vector<Behavior::State> states;
+    std::vector<std::pair<uint32_t, Behavior::Trans>> edges;   //  起始状态, 转移
+    std::vector<Squad> squads;
+
+    std::istringstream lines(text);
+    std::string line;
+    for (size_t number = 1; std::getline(lines, line); ++number)
+    {
+        auto fail = [&] (const std::string & message)
+        {
+            error = "line " + std::to_string(number) + ": " + message;
+            return false;
+        };
+
+        line = line.substr(0, line.find('#'));
+        std::istringstream args(line);
+        std::string op;
+        if (!(args >> op)) { continue; }
+
+        auto find = [&] (const std::map<std::string, uint32_t> & table, uint32_t & index)
+        {
+            std::string name;
+            args >> name;
+            auto it = table.find(name);
+            if (it == table.end()) { return false; }
+            index = it->second;
+            return true;
+        };
+        auto prefab = [&] (uint32_t & index) { return find(names, index); };
+
+        if (op == "hero")
+        {
+            if (!(args >> setting.mHero.x >> setting.mHero.y)) { return fail("hero <x> <y>"); }
+        }
+        else if (op == "boss")
+        {
+            if (!(args >> setting.mBossItems >> setting.mBossHp >> setting.mFireCD >> setting.mRageHp >> setting.mRageCD)
+                || setting.mBossItems == 0 || setting.mBossHp <= 0 || setting.mFireCD <= 0 || setting.mRageCD <= 0)
+            {
+                return fail("boss <items> <hp> <fire cd> <rage hp> <rage cd>");
+            }
+        }
+        else if (op == "path")
+        {
+            Path path = { (uint32_t)points.size(), 0 };
+            Vec2 point;
+            while (args >> point.x >> point.y)
+            {
+                points.push_back(point);
+                ++path.mCount;
+            }
+            if (path.mCount < 2) { return fail("path needs at least two points"); }
+            paths.push_back(path);
+        }
+        else if (op == "wave")
+        {
+            Wave wave;
+            if (!(args >> wave.mTime >> wave.mCount)) { return fail("wave <time> <count>"); }
+            if (!waves.empty() && wave.mTime < waves.back().mTime) { return fail("waves must be in time order"); }
+            waves.push_back(wave);
+        }
+        else if (op == "repeat")
+        {
+            if (!(args >> setting.mRepeat) || setting.mRepeat < 0) { return fail("repeat <interval>"); }
+        }
+        else if (op == "prefab")
+        {
+            Prefab record = { };
+            record.mLayer = kNoLayer;
+
+            std::string name, clip, layer, shape;
+            if (!(args >> name >> clip)) { return fail("prefab <name> <clip> [<layer> <shape> ...]"); }
+            if (name.size() >= sizeof(record.mName) || clip.size() >= sizeof(record.mClip)) { return fail("name too long"); }
+            if (names.count(name) != 0) { return fail("duplicate prefab " + name); }
+            std::strcpy(record.mName, name.c_str());
+            std::strcpy(record.mClip, clip.c_str());
+
+            if (args >> layer)
+            {
+                auto it = std::find(std::begin(sLayers), std::end(sLayers), layer);
+                if (it == std::end(sLayers)) { return fail("unknown layer " + layer); }
+                record.mLayer = (uint32_t)(it - std::begin(sLayers));
+
+                args >> shape;
+                auto ok = false;
+                if (shape == "circle")
+                {
+                    record.mShape = (uint32_t)Collide::Shape::kCircle;
+                    ok = (bool)(args >> record.mRadius);
+                }
+                else if (shape == "capsule")
+                {
+                    record.mShape = (uint32_t)Collide::Shape::kCapsule;
+                    ok = (bool)(args >> record.mRadius >> record.mHalf.x);
+                }
+                else if (shape == "box")
+                {
+                    record.mShape = (uint32_t)Collide::Shape::kBox;
+                    ok = (bool)(args >> record.mHalf.x >> record.mHalf.y);
+                    args >> record.mRadius;
+                }
+                if (!ok) { return fail("shape: circle <r> | capsule <r> <half> | box <hx> <hy> [r]"); }
+            }
+            names.emplace(name, (uint32_t)prefabs.size());
+            prefabs.push_back(record);
+        }
+        else if (op == "actor")
+        {
+            uint32_t index = 0;
+            Vec2 coord;
+            if (!prefab(index)) { return fail("unknown prefab"); }
+            if (!(args >> coord.x >> coord.y)) { return fail("actor <prefab> <x> <y>"); }
+            actors.emplace_back(index, coord);
+        }
+        else if (op == "grid")
+        {
+            uint32_t index = 0, cols = 0, rows = 0;
+            Vec2 a, b;
+            if (!prefab(index)) { return fail("unknown prefab"); }
+            if (!(args >> a.x >> a.y >> b.x >> b.y >> cols >> rows) || cols == 0 || rows == 0)
+            {
+                return fail("grid <prefab> <x0> <y0> <x1> <y1> <cols> <rows>");
+            }
+            auto step = Vec2(cols > 1 ? (b.x - a.x) / (cols - 1) : 0, rows > 1 ? (b.y - a.y) / (rows - 1) : 0);
+            for (uint32_t y = 0; y != rows; ++y)
+            {
+                for (uint32_t x = 0; x != cols; ++x)
+                {
+                    actors.emplace_back(index, Vec2(a.x + step.x * x, a.y + step.y * y));
+                }
+            }
+        }
+        else if (op == "machine")
+        {
+            Machine record = { };
+
+            std::string name, image;
+            if (!(args >> name >> image >> record.mHp >> record.mRadius) || record.mHp <= 0)
+            {
+                return fail("machine <name> <image> <hp> <radius>");
+            }
+            if (name.size() >= sizeof(record.mName) || image.size() >= sizeof(record.mImage)) { return fail("name too long"); }
+            if (machineNames.count(name) != 0) { return fail("duplicate machine " + name); }
+            std::strcpy(record.mName, name.c_str());
+            std::strcpy(record.mImage, image.c_str());
+            record.mState = UINT32_MAX;
+            machineNames.emplace(name, (uint32_t)machines.size());
+            machines.push_back(record);
+        }
+        else if (op == "state")
+        {
+            static const char * sMoves[] = { "hold", "chase", "flee", "orbit", "drift" };
+
+            uint32_t machine = 0;
+            std::string name, move, aim;
+            Behavior::State state = { };
+            if (!find(machineNames, machine)) { return fail("unknown machine"); }
+            if (!(args >> name >> move >> state.mSpeed >> state.mParam >> state.mSpin >> state.mFireCD >> aim)
+                || state.mFireCD < 0 || (aim != "aim" && aim != "ahead"))
+            {
+                return fail("state <machine> <state> <move> <speed> <param> <spin> <fire cd> <aim|ahead>");
+            }
+            auto it = std::find(std::begin(sMoves), std::end(sMoves), move);
+            if (it == std::end(sMoves)) { return fail("unknown move " + move); }
+            state.mMove = (Behavior::Move)(it - std::begin(sMoves));
+            state.mAim  = aim == "aim";
+
+            auto key = std::string(machines[machine].mName) + "." + name;
+            if (stateNames.count(key) != 0) { return fail("duplicate state " + key); }
+            if (machines[machine].mState == UINT32_MAX) { machines[machine].mState = (uint32_t)states.size(); }
+            stateNames.emplace(key, (uint32_t)states.size());
+            states.push_back(state);
+        }
+        else if (op == "on")
+        {
+            static const char * sConds[] = { "after", "near", "far", "hurt" };
+
+            std::string machine, from, to, cond;
+            Behavior::Trans record = { };
+            if (!(args >> machine >> from >> to >> cond >> record.mValue))
+            {
+                return fail("on <machine> <from> <to> <cond> <value>");
+            }
+            auto a = stateNames.find(machine + "." + from);
+            auto b = stateNames.find(machine + "." + to);
+            if (a == stateNames.end() || b == stateNames.end()) { return fail("unknown state"); }
+            auto it = std::find(std::begin(sConds), std::end(sConds), cond);
+            if (it == std::end(sConds)) { return fail("unknown condition " + cond); }
+            record.mTo   = b->second;
+            record.mCond = (Behavior::Cond)(it - std::begin(sConds));
+            edges.emplace_back(a->second, record);
+        }
+        else if (op == "squad")
+        {
+            Squad squad = { };
+            if (!find(machineNames, squad.mMachine)) { return fail("unknown machine"); }
+            if (!(args >> squad.mTime >> squad.mCount >> squad.mMin.x >> squad.mMin.y >> squad.mMax.x >> squad.mMax.y))
+            {
+                return fail("squad <machine> <time> <count> <x0> <y0> <x1> <y1>");
+            }
+            squads.push_back(squad);
+        }
+        else
+        {
+            return fail("unknown op " + op);
+        }
+    }
+
+    if (setting.mBossItems == 0) { error = "missing boss"; return false; }
+    if (paths.empty())           { error = "missing path"; return false; }
+    for (auto & machine : machines)
+    {
+        if (machine.mState == UINT32_MAX) { error = std::string("machine without state ") + machine.mName; return false; }
+    }
+
+    //  转移按起始状态归并, 同一状态内保持书写顺序
+    std::stable_sort(edges.begin(), edges.end(), [] (auto & a, auto & b) { return a.first < b.first; });
+    std::vector<Behavior::Trans> trans;
+    for (auto & pair : edges)
+    {
+        auto & state = states[pair.first];
+        if (state.mCount == 0) { state.mFirst = (uint32_t)trans.size(); }
+        ++state.mCount;
+        trans.push_back(pair.second);
+    }
+    std::stable_sort(squads.begin(), squads.end(), [] (auto & a, auto & b) { return a.mTime < b.mTime; });
+
+    //  按预制体归并成段, 生成时每段一次批量调用
+    std::stable_sort(actors.begin(), actors.end(), [] (auto & a, auto & b) { return a.first < b.first; });
+    std::vector<Run>  runs;
+    std::vector<Vec2> coords;
+    for (auto & actor : actors)
+    {
+        if (runs.empty() || runs.back().mPrefab != actor.first)
+        {
+            runs.push_back({ actor.first, (uint32_t)coords.size(), 0, 0 });
+        }
+        ++runs.back().mCount;
+        coords.push_back(actor.second);
+    }
+
+    std::vector<Archive::Item> items;
+    items.push_back(MakeTable("setting", std::vector<Setting>{ setting }));
+    items.push_back(MakeTable("prefab", prefabs));
+    items.push_back(MakeTable("run",    runs));
+    items.push_back(MakeTable("coord",  coords));
+    items.push_back(MakeTable("path",   paths));
+    items.push_back(MakeTable("point",  points));
+    items.push_back(MakeTable("wave",   waves));
+    items.push_back(MakeTable("machine", machines));
+    items.push_back(MakeTable("state",  states));
+    items.push_back(MakeTable("trans",  trans));
+    items.push_back(MakeTable("squad",  squads));
+    out = Archive::Build(items);
+    return true;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Math.h"
+#include "Archive.h"
+#include "Behavior.h"
+
+//  关卡: 资源包格式, 每张表一个条目, 记录为定长结构
+//  映射后原地按数组访问, Actor坐标直接交给批量生成, 不经解析和复制
+//  单位为像素
+class Scene {
+public:
+    static const uint32_t kNoLayer = UINT32_MAX;
+
+    //  全局设定, 一条
+    struct Setting {
+        Vec2     mHero;         //  主角出生点
+        uint32_t mBossItems;    //  Boss节数
+        int32_t  mBossHp;
+        float    mFireCD;       //  开火间隔
+        int32_t  mRageHp;       //  血量低于此值后
+        float    mRageCD;       //  改用的开火间隔
+        float    mRepeat;       //  最后一波之后的重复间隔, 0不重复
+    };
+
+    //  关卡预制体: 精灵加可选的碰撞
+    struct Prefab {
+        char     mName[32];
+        char     mClip[32];
+        uint32_t mLayer;        //  Game::CollisionLayer, kNoLayer无碰撞
+        uint32_t mShape;        //  Collide::Shape
+        float    mRadius;
+        Vec2     mHalf;
+    };
+
+    //  同一预制体的一段Actor, 坐标为mCoords[mFirst, mFirst + mCount)
+    struct Run {
+        uint32_t mPrefab;       //  名字在mPrefabs中的下标
+        uint32_t mFirst;
+        uint32_t mCount;
+        uint32_t mPad;
+    };
+
+    //  Boss路径, 控制点为mPoints[mFirst, mFirst + mCount)
+    struct Path {
+        uint32_t mFirst;
+        uint32_t mCount;
+    };
+
+    //  敌群波次, 按时刻升序
+    struct Wave {
+        float    mTime;
+        uint32_t mCount;
+    };
+
+    //  状态机驱动的敌人类型, 初始状态为mStates[mState]
+    struct Machine {
+        char     mName[32];
+        char     mImage[32];
+        int32_t  mHp;
+        float    mRadius;
+        uint32_t mState;
+        uint32_t mPad;
+    };
+
+    //  到时刻在矩形内随机出现一批, 按时刻升序
+    struct Squad {
+        uint32_t mMachine;
+        float    mTime;
+        uint32_t mCount;
+        uint32_t mPad;
+        Vec2     mMin;
+        Vec2     mMax;
+    };
+
+    //  只读的表视图
+    template <typename T>
+    struct Table {
+        const T * mData;
+        uint32_t  mCount;
+
+        const T * begin() const { return mData; }
+        const T * end() const { return mData + mCount; }
+        const T & operator [] (size_t i) const { return mData[i]; }
+        uint32_t Size() const { return mCount; }
+    };
+
+    Scene() : mSetting(nullptr)
+    { }
+
+    //  映射编译好的关卡
+    bool Open(const std::string & path);
+
+    //  读入源文件并在内存中编译, 缺少编译结果时使用
+    bool Load(const std::string & path, std::string & error);
+
+    //  源文本编译为资源包字节流, 离线工具与Load共用
+    static bool Compile(const std::string & text, std::vector<uint8_t> & out, std::string & error);
+
+    bool IsOpen() const { return mSetting != nullptr; }
+
+    const Setting & Settings() const { return *mSetting; }
+
+    Table<Prefab> mPrefabs;
+    Table<Run>    mRuns;
+    Table<Vec2>   mCoords;
+    Table<Path>   mPaths;
+    Table<Vec2>   mPoints;
+    Table<Wave>   mWaves;
+    Table<Machine>          mMachines;
+    Table<Behavior::State>  mStates;
+    Table<Behavior::Trans>  mTrans;
+    Table<Squad>            mSquads;
+
+private:
+    Scene(const Scene &) = delete;
+    Scene & operator=(const Scene &) = delete;
+
+    //  绑定各表并校验下标, 失败时关闭
+    bool Bind();
+
+    Archive               mArchive;
+    std::vector<uint8_t>  mBuffer;      //  内存中编译的结果
+    const Setting *       mSetting;
+};
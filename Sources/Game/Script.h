@@ -0,0 +1,304 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <exception>
+#include <coroutine>
+#include "Timer.h"
+#include "Memory.h"
+
+//  协程脚本: 休眠挂在Timer上, 条件等待每帧轮询, 挂起期间不占用Update
+//  协程帧来自所在世界的分级池, 池热身后生成脚本不再分配
+namespace Script {
+    class Scheduler;
+
+    //  协程帧池, 按64字节分级的空闲链表, 块在池析构时归还系统
+    //  每个世界一个, 由Game::BindWorld绑定到推进它的线程; 块头记录所属的池, 释放时交还原池
+    class Pool {
+    public:
+        Pool() : mHeads()
+        { }
+
+        Pool(const Pool &) = delete;
+        Pool & operator = (const Pool &) = delete;
+
+        ~Pool()
+        {
+            for (auto chunk : mChunks) { ::operator delete(chunk); }
+        }
+
+        //  当前线程绑定的池, 未绑定世界的线程用线程自己的池
+        static Pool *& Current()
+        {
+            static thread_local Pool   sLocal;
+            static thread_local Pool * sPool = &sLocal;
+            return sPool;
+        }
+
+        static void * Alloc(size_t size)
+        {
+            return Current()->Acquire(size);
+        }
+
+        static void Free(void * p, size_t size)
+        {
+            auto header = (Header *)p - 1;
+            header->mPool->Release(header, size);
+        }
+
+    private:
+        struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) Header {
+            Pool * mPool;
+        };
+
+        static const size_t kAlign   = 64;
+        static const size_t kClasses = 16;      //  至1KB
+        static const size_t kChunk   = 64;      //  每次补充的块数
+
+        static size_t Index(size_t size)
+        {
+            return (size + sizeof(Header) + kAlign - 1) / kAlign;
+        }
+
+        void * Acquire(size_t size)
+        {
+            auto index = Index(size);
+            Header * header;
+            if (index >= kClasses)
+            {
+                Memory::Scope scope(Memory::Tag::kScript);
+                header = (Header *)::operator new(size + sizeof(Header));
+            }
+            else
+            {
+                auto & head = mHeads[index];
+                if (head == nullptr) { Refill(index); }
+                header = (Header *)head;
+                head = *(void **)header;
+            }
+            header->mPool = this;
+            return header + 1;
+        }
+
+        void Release(Header * header, size_t size)
+        {
+            auto index = Index(size);
+            if (index >= kClasses)
+            {
+                ::operator delete(header);
+                return;
+            }
+            *(void **)header = mHeads[index];
+            mHeads[index] = header;
+        }
+
+        void Refill(size_t index)
+        {
+            Memory::Scope scope(Memory::Tag::kScript);
+            auto size  = index * kAlign;
+            auto chunk = (char *)::operator new(size * kChunk);
+            mChunks.push_back(chunk);
+            for (size_t i = 0; i != kChunk; ++i)
+            {
+                *(void **)(chunk + i * size) = mHeads[index];
+                mHeads[index] = chunk + i * size;
+            }
+        }
+
+        void * mHeads[kClasses];
+        std::vector<void *, Memory::Allocator<void *, Memory::Tag::kScript>> mChunks;
+    };
+
+    //  脚本句柄, 析构时结束脚本
+    //  挂起中的脚本只做标记, 由唤醒方释放, 取消是O(1)
+    class Task {
+    public:
+        struct promise_type {
+            float mTime     = 0;        //  最近一次定时唤醒的时刻, 连续Wait以此为起点
+            bool  mIsTimed  = false;    //  本段由定时器唤醒
+            bool  mIsPark   = false;    //  挂在Timer或轮询表上
+            bool  mIsCancel = false;    //  挂起期间句柄已析构
+
+            static void * operator new(size_t size) { return Pool::Alloc(size); }
+            static void operator delete(void * p, size_t size) { Pool::Free(p, size); }
+
+            Task get_return_object() { return Task(Handle::from_promise(*this)); }
+            std::suspend_never initial_suspend() { return { }; }
+            std::suspend_always final_suspend() noexcept { return { }; }
+            void return_void() { }
+            void unhandled_exception() { std::terminate(); }
+        };
+        using Handle = std::coroutine_handle<promise_type>;
+
+        Task() : mHandle(nullptr)
+        { }
+
+        Task(Task && other) : mHandle(other.mHandle)
+        {
+            other.mHandle = nullptr;
+        }
+
+        Task & operator = (Task && other)
+        {
+            if (this != &other)
+            {
+                Reset();
+                mHandle = other.mHandle;
+                other.mHandle = nullptr;
+            }
+            return *this;
+        }
+
+        Task(const Task &) = delete;
+        Task & operator = (const Task &) = delete;
+
+        ~Task()
+        {
+            Reset();
+        }
+
+        void Reset()
+        {
+            if (mHandle)
+            {
+                if (mHandle.promise().mIsPark)
+                {
+                    mHandle.promise().mIsCancel = true;
+                }
+                else
+                {
+                    mHandle.destroy();
+                }
+                mHandle = nullptr;
+            }
+        }
+
+        bool IsDone() const
+        {
+            return !mHandle || mHandle.done();
+        }
+
+    private:
+        explicit Task(Handle handle) : mHandle(handle)
+        { }
+
+        Handle mHandle;
+    };
+
+    class Scheduler {
+    public:
+        //  条件等待, 对象位于协程帧内
+        struct Poll {
+            Task::Handle mHandle;
+
+            virtual bool Test() = 0;
+        };
+
+        Scheduler() : mTimer(nullptr)
+        { }
+
+        void Init(Timer * timer)
+        {
+            mTimer = timer;
+        }
+
+        //  定时唤醒, 起点是本段的定时唤醒时刻, 否则是now, 节奏不随帧漂移
+        void Sleep(Task::Handle handle, float time, float now)
+        {
+            Memory::Scope scope(Memory::Tag::kScript);
+            auto & promise = handle.promise();
+            promise.mTime    = (promise.mIsTimed ? promise.mTime : now) + time;
+            promise.mIsTimed = true;
+            promise.mIsPark  = true;
+            mTimer->Reg(promise.mTime, [handle] { Wake(handle); });
+        }
+
+        void Wait(Poll * poll)
+        {
+            Memory::Scope scope(Memory::Tag::kScript);
+            auto & promise = poll->mHandle.promise();
+            promise.mIsTimed = false;
+            promise.mIsPark  = true;
+            mPolls.push_back(poll);
+        }
+
+        //  每帧一次, 先摘下满足的等待再恢复, 恢复中可追加新的等待
+        void Update()
+        {
+            mReady.clear();
+            for (size_t i = 0; i != mPolls.size();)
+            {
+                auto poll = mPolls[i];
+                if (poll->mHandle.promise().mIsCancel || poll->Test())
+                {
+                    mReady.push_back(poll->mHandle);
+                    mPolls[i] = mPolls.back();
+                    mPolls.pop_back();
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+            for (auto handle : mReady)
+            {
+                Wake(handle);
+            }
+        }
+
+        size_t PollCount() const
+        {
+            return mPolls.size();
+        }
+
+    private:
+        static void Wake(Task::Handle handle)
+        {
+            auto & promise = handle.promise();
+            promise.mIsPark = false;
+            if (promise.mIsCancel)
+            {
+                handle.destroy();
+            }
+            else
+            {
+                handle.resume();
+            }
+        }
+
+        Timer * mTimer;
+        std::vector<Poll *, Memory::Allocator<Poll *, Memory::Tag::kScript>>               mPolls;
+        std::vector<Task::Handle, Memory::Allocator<Task::Handle, Memory::Tag::kScript>>   mReady;
+    };
+
+    //  co_await Sleep(scheduler, time, now)
+    struct Sleep {
+        Scheduler & mScheduler;
+        float       mTime;
+        float       mNow;
+
+        Sleep(Scheduler & scheduler, float time, float now)
+            : mScheduler(scheduler), mTime(time), mNow(now)
+        { }
+
+        bool await_ready() const { return false; }
+        void await_suspend(Task::Handle handle) { mScheduler.Sleep(handle, mTime, mNow); }
+        void await_resume() { }
+    };
+
+    //  co_await Until(scheduler, fn), fn已满足时不挂起
+    template <class Fn>
+    struct Until : public Scheduler::Poll {
+        Scheduler & mScheduler;
+        Fn          mFn;
+
+        Until(Scheduler & scheduler, Fn fn) : mScheduler(scheduler), mFn(fn)
+        { }
+
+        virtual bool Test() override { return mFn(); }
+
+        bool await_ready() { return mFn(); }
+        void await_suspend(Task::Handle handle) { mHandle = handle; mScheduler.Wait(this); }
+        void await_resume() { }
+    };
+}
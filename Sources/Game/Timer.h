@@ -1,6 +1,7 @@
 #pragma once
 
-#include <queue>
+#include <vector>
+#include <algorithm>
 #include <functional>
 
 class Timer {
@@ -18,12 +19,12 @@ public:
         Item(int id, float time, const Handler & func) : mID(id), mTime(time), mFunc(func)
         { }
 
-        bool operator < (const Item & v)
+        bool operator < (const Item & v) const
         {
             return mTime < v.mTime;
         }
 
-        bool operator > (const Item & v)
+        bool operator > (const Item & v) const
         {
             return mTime > v.mTime;
         }
@@ -41,7 +42,7 @@ public:
     {
         Item item(++mID, time, func);
         mItems.push_back(item);
-        std::push_heap(mItems.begin(), mItems.end());
+        std::push_heap(mItems.begin(), mItems.end(), std::greater<Item>());
         return item.mID;
     }
 
@@ -51,17 +52,19 @@ public:
         auto it = std::remove_if(mItems.begin(), mItems.end(), fn);
         if (it != mItems.end())
         {
-            mItems.erase(it); std::make_heap(mItems.begin(), mItems.end());
+            mItems.erase(it); std::make_heap(mItems.begin(), mItems.end(), std::greater<Item>());
         }
     }
 
+    //  Min-heap: fire every due item, popping it before the callback so callbacks may register again
     void Call(float time)
     {
-        for (; !mItems.empty() && mItems.front().mTime >= time;)
+        while (!mItems.empty() && mItems.front().mTime <= time)
         {
-            const auto&top = mItems.front();top.mFunc();
-            std::pop_heap(mItems.begin(), mItems.end());
+            std::pop_heap(mItems.begin(), mItems.end(), std::greater<Item>());
+            auto func = std::move(mItems.back().mFunc);
             mItems.pop_back();
+            func();
         }
     }
 
@@ -6,14 +6,16 @@ int main(int argc, char *argv[])
 	Simple2D::Window* pWindow = Simple2D::CreateWindow("ShooterGame", Game::mWindowW, Game::mWindowH);
 
 	Game::GameInit();
+	Game::SimulateStart();
 
 	while (!Simple2D::ShouldWindowClose(pWindow))
 	{
-		Game::GameStep();
-
-		Simple2D::RefreshWindowBuffer(pWindow);
+		Game::SampleInput();
+		Game::RenderFrame(pWindow);
 	}
 
+	Game::SimulateStop();
+
 	Simple2D::DestroyWindow(pWindow);
 }
 
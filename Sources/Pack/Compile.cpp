@@ -0,0 +1,43 @@
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include "Game/Scene.h"
+
+//  离线关卡编译: ShooterScene <输出.scene> <关卡.txt>
+//  格式见Scene::Compile, 游戏优先映射编译结果, 缺失时再读源文件
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "usage: ShooterScene <output.scene> <level.txt>" << std::endl; return 1;
+    }
+
+    std::ifstream ifile(argv[2]);
+    if (!ifile)
+    {
+        std::cerr << argv[2] << ": cannot open" << std::endl; return 1;
+    }
+    std::stringstream text;
+    text << ifile.rdbuf();
+
+    std::vector<uint8_t> bytes;
+    std::string error;
+    if (!Scene::Compile(text.str(), bytes, error))
+    {
+        std::cerr << argv[2] << ": " << error << std::endl; return 1;
+    }
+
+    std::ofstream ofile(argv[1], std::ios::binary);
+    ofile.write((const char *)bytes.data(), (std::streamsize)bytes.size());
+    ofile.flush();
+    if (!ofile)
+    {
+        std::cerr << argv[1] << ": write failed" << std::endl; return 1;
+    }
+
+    std::cout << argv[1] << ": " << bytes.size() << " bytes" << std::endl;
+    return 0;
+}
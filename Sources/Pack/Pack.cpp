@@ -0,0 +1,106 @@
+#include <png.h>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include "Game/Archive.h"
+
+//  离线打包: ShooterPack <输出.pak> <Content目录>
+//  Textures/*.png 预解码为RGBA8, Fonts/*.ttf 原样存入, 以文件名(无扩展名)索引
+
+namespace fs = std::filesystem;
+
+namespace {
+    using Item = Archive::Item;
+
+    bool DecodePng(const fs::path & path, Item & item)
+    {
+        png_image png;
+        std::memset(&png, 0, sizeof(png));
+        png.version = PNG_IMAGE_VERSION;
+        if (png_image_begin_read_from_file(&png, path.string().c_str()) == 0)
+        {
+            std::cerr << path << ": " << png.message << std::endl; return false;
+        }
+        png.format = PNG_FORMAT_RGBA;
+        item.mData.resize(PNG_IMAGE_SIZE(png));
+        if (png_image_finish_read(&png, nullptr, item.mData.data(), 0, nullptr) == 0)
+        {
+            std::cerr << path << ": " << png.message << std::endl; return false;
+        }
+        item.mEntry.mKind   = Archive::Kind::kImage;
+        item.mEntry.mWidth  = png.width;
+        item.mEntry.mHeight = png.height;
+        return true;
+    }
+
+    bool ReadFile(const fs::path & path, Item & item)
+    {
+        std::ifstream ifile(path, std::ios::binary);
+        item.mData.assign(std::istreambuf_iterator<char>(ifile), std::istreambuf_iterator<char>());
+        item.mEntry.mKind = Archive::Kind::kFont;
+        return ifile.good() || ifile.eof();
+    }
+
+    std::vector<fs::path> ListFiles(const fs::path & dir, const std::string & ext)
+    {
+        std::vector<fs::path> paths;
+        for (auto & file : fs::directory_iterator(dir))
+        {
+            auto e = file.path().extension().string();
+            std::transform(e.begin(), e.end(), e.begin(), ::tolower);
+            if (file.is_regular_file() && e == ext) { paths.push_back(file.path()); }
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "usage: ShooterPack <output.pak> <content dir>" << std::endl; return 1;
+    }
+
+    std::vector<Item> items;
+    auto append = [&] (const fs::path & path, bool (*load)(const fs::path &, Item &))
+    {
+        Item item;
+        std::memset(&item.mEntry, 0, sizeof(item.mEntry));
+        auto name = path.stem().string();
+        if (name.size() >= sizeof(item.mEntry.mName))
+        {
+            std::cerr << path << ": name too long" << std::endl; return false;
+        }
+        std::strcpy(item.mEntry.mName, name.c_str());
+        if (!load(path, item)) { return false; }
+        items.push_back(std::move(item));
+        return true;
+    };
+
+    fs::path content(argv[2]);
+    for (auto & path : ListFiles(content / "Textures", ".png"))
+    {
+        if (!append(path, DecodePng)) { return 1; }
+    }
+    for (auto & path : ListFiles(content / "Fonts", ".ttf"))
+    {
+        if (!append(path, ReadFile)) { return 1; }
+    }
+
+    auto bytes = Archive::Build(items);
+    std::ofstream ofile(argv[1], std::ios::binary);
+    ofile.write((const char *)bytes.data(), (std::streamsize)bytes.size());
+    ofile.flush();
+    if (!ofile)
+    {
+        std::cerr << argv[1] << ": write failed" << std::endl; return 1;
+    }
+
+    std::cout << argv[1] << ": " << items.size() << " entries, " << bytes.size() << " bytes" << std::endl;
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include <set>
+#include <random>
+#include <utility>
+#include <iostream>
+#include "Game/Game.h"
+
+//  游戏的碰撞层矩阵(Game::InitLayers)与各层mSelf/mMask语义一致:
+//  矩阵逐项等于各层代表的IsInterest, Update的碰撞对 == 全体两两IsInterest + 形状相交
+
+namespace {
+    const uint32_t kBullet = (uint32_t)Game::CollisionTag::kBullet;
+    const uint32_t kPlayer = (uint32_t)Game::CollisionTag::kPlayer;
+    const uint32_t kEnemy  = (uint32_t)Game::CollisionTag::kEnemy;
+
+    struct Layer {
+        uint32_t mSelf;
+        uint32_t mMask;
+    };
+
+    //  按Game::CollisionLayer排列, 标记与Play中各预制体的碰撞组件一致
+    const Layer sLayers[] = {
+        { kPlayer,           kPlayer },     //  玩家
+        { kPlayer | kBullet, kPlayer },     //  玩家子弹
+        { kEnemy,            kEnemy  },     //  敌人
+        { kEnemy  | kBullet, kEnemy  },     //  敌人子弹
+    };
+    const uint32_t kLayers = std::size(sLayers);
+
+    using PairSet = std::set<std::pair<const Collide::Body *, const Collide::Body *>>;
+
+    void Insert(PairSet & set, const Collide::Body * a, const Collide::Body * b)
+    {
+        set.emplace(std::min(a, b), std::max(a, b));
+    }
+
+    bool IsOverlap(const Collide::Body * a, const Collide::Body * b)
+    {
+        if (a->mShape == Collide::Shape::kCircle && b->mShape == Collide::Shape::kCircle)
+        {
+            auto time = 0.0f;
+            return Collide::IsOverlap(a, b, time);
+        }
+        return Collide::IsOverlap(Collide::ToRect(a), Collide::ToRect(b));
+    }
+
+    //  返回与标记不一致的矩阵项数
+    size_t Matrix()
+    {
+        Collide collide;
+        Game::InitLayers(collide);
+
+        size_t diff = 0;
+        for (uint32_t a = 0; a != kLayers; ++a)
+        {
+            for (uint32_t b = 0; b != kLayers; ++b)
+            {
+                Collide::Body x = { }, y = { };
+                x.mSelf = sLayers[a].mSelf; x.mMask = sLayers[a].mMask;
+                y.mSelf = sLayers[b].mSelf; y.mMask = sLayers[b].mMask;
+                if (collide.IsInteract(a, b) != Collide::IsInterest(&x, &y))
+                {
+                    std::cerr << "layer " << a << " x " << b << ": matrix " << collide.IsInteract(a, b)
+                              << ", masks " << Collide::IsInterest(&x, &y) << std::endl;
+                    ++diff;
+                }
+            }
+        }
+        return diff;
+    }
+
+    //  返回不一致的对数
+    size_t Round(std::mt19937 & mt, size_t count)
+    {
+        std::uniform_real_distribution<float> coord(0, 800);
+        std::uniform_real_distribution<float> size(2, 30);
+        std::uniform_real_distribution<float> angle(0, 360);
+
+        std::vector<Collide::Body> bodies(count);
+        Collide collide;
+        Game::InitLayers(collide);
+
+        for (size_t i = 0; i != count; ++i)
+        {
+            auto & body = bodies[i];
+            auto & layer = sLayers[mt() % kLayers];
+            body = { };
+            body.mCoord  = Vec2(coord(mt), coord(mt));
+            body.mRadius = size(mt);
+            body.mSelf   = layer.mSelf;
+            body.mMask   = layer.mMask;
+            body.mLayer  = (uint32_t)(&layer - sLayers);
+            body.mShape  = (Collide::Shape)(mt() % 3);
+            body.mAxis   = Math::ToVec(angle(mt));
+            body.mHalf   = Vec2(size(mt), size(mt));
+            body.mUser   = &body;
+            collide.Insert(&body);
+        }
+
+        PairSet expect, actual;
+        for (size_t i = 0; i != count; ++i)
+        {
+            for (auto j = i + 1; j != count; ++j)
+            {
+                auto a = &bodies[i], b = &bodies[j];
+                if (Collide::IsInterest(a, b) && IsOverlap(a, b)) { Insert(expect, a, b); }
+            }
+        }
+        for (auto & pair : collide.Update())
+        {
+            Insert(actual, pair.mA, pair.mB);
+        }
+
+        size_t diff = 0;
+        for (auto & pair : expect) { diff += actual.count(pair) == 0; }
+        for (auto & pair : actual) { diff += expect.count(pair) == 0; }
+        if (diff != 0 || actual.size() != collide.mPairs.size())
+        {
+            std::cerr << "pairs: expect " << expect.size() << ", actual " << collide.mPairs.size()
+                      << ", mismatch " << diff << std::endl;
+        }
+        //  重复的对与空结果同样视为失败, 避免测试形同虚设
+        return diff + (collide.mPairs.size() - actual.size()) + expect.empty();
+    }
+}
+
+int main()
+{
+    std::mt19937 mt(1);
+    size_t fails = Matrix() != 0;
+    for (auto i = 0; i != 20; ++i)
+    {
+        fails += Round(mt, 3000) != 0;
+    }
+    std::cout << "collide layers: " << (fails == 0 ? "ok" : "FAILED") << std::endl;
+    return fails == 0 ? 0 : 1;
+}